@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    Denormals.h
+    Helpers for keeping filter states out of the denormal range and for
+    counting denormal results when debugging
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>    //Including cmath for maths functions
+
+// =================================
+// =================================
+// Denormals
+
+/*!
+ @class Denormals
+ @abstract static helpers for dealing with denormal numbers
+ @discussion recursive filters fed silence decay towards zero forever and their states end up
+             as denormals, which are very slow on x86 when flush to zero is not turned on. The
+             filters flush their states once per block with flush so they never get there
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class Denormals
+{
+public:
+    //Level below which states are set to 0, around -400dB so it is never heard but far above
+    //the denormal range of doubles and of the floats the filter outputs are converted to
+    static constexpr double flushLevel = 1e-20;
+
+    /**
+     * Sets a value to 0 if it is too small to matter
+     *
+     * @param value is the value to check
+     *
+     * @return 0 if the value is smaller than flushLevel, otherwise the value
+     *
+    */
+    static inline double flush(double value)
+    {
+        return std::abs(value) < flushLevel ? 0.0 : value;
+    }
+
+    /**
+     * Counts the denormal values in an array
+     *
+     * @param values is the array to check
+     * @param numValues is the number of values in the array
+     *
+     * @return the number of denormal values
+     *
+    */
+    static inline int count(const float* values, int numValues)
+    {
+        int numDenormals = 0;
+        for(int i = 0; i < numValues; ++i)
+            numDenormals += std::fpclassify(values[i]) == FP_SUBNORMAL ? 1 : 0;
+        return numDenormals;
+    }
+};
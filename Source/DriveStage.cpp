@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    DriveStage.cpp
+    Saturation of stereo samples with first order antiderivative anti-aliasing
+    so the drive can run at the voices sample rate without oversampling
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "DriveStage.h"
+
+ADAADrive::ADAADrive(){}
+
+ADAADrive::~ADAADrive(){}
+
+void ADAADrive::setMode(int newMode)
+{
+    newMode = (newMode < off || newMode > asymmetric) ? (int) off : newMode;    //If out of range turn the drive off
+    if(mode != newMode)
+    {
+        mode = newMode;
+        reset();    //The stored antiderivatives belong to the old curve
+    }
+}
+
+void ADAADrive::setNumChannels(int newNumChannels)
+{
+    newNumChannels = newNumChannels < 1 ? 1 : (newNumChannels > numChannels ? numChannels : newNumChannels);
+    if(activeChannels != newNumChannels)
+    {
+        activeChannels = newNumChannels;
+        reset();    //A channel that is switched back on would start from an old input
+    }
+}
+
+void ADAADrive::reset()
+{
+    for(int ch = 0; ch < numChannels; ++ch)
+    {
+        lastInput[ch] = 0.0;
+        lastAntiderivative[ch] = 0.0;
+    }
+}
+
+void ADAADrive::process(float* const* channels, int numSamples, const float* amountRamp, float amount)
+{
+    if(mode == off)
+        return;
+    
+    const double blockGain = calcGain(amount);
+    float lastAmount = amount;
+    double gain = blockGain;
+    
+    for(int i = 0; i < numSamples; ++i)
+    {
+        if(amountRamp != nullptr && amountRamp[i] != lastAmount)    //Only work out the gain when the amount moves
+        {
+            lastAmount = amountRamp[i];
+            gain = calcGain(lastAmount);
+        }
+        
+        for(int ch = 0; ch < activeChannels; ++ch)
+        {
+            const double x = gain * channels[ch][i];
+            const double step = x - lastInput[ch];
+            const double antiderivativeX = antiderivative(x);
+            
+            //Average of the curve bettween the last input and this one
+            const double y = std::abs(step) < minStep ? curve(0.5 * (x + lastInput[ch])) : (antiderivativeX - lastAntiderivative[ch]) / step;
+            
+            lastInput[ch] = x;
+            lastAntiderivative[ch] = antiderivativeX;
+            channels[ch][i] = (float) y;
+        }
+    }
+}
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    DriveStage.h
+    Saturation of stereo samples with first order antiderivative anti-aliasing
+    so the drive can run at the voices sample rate without oversampling
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>    //Including cmath for maths functions
+
+// =================================
+// =================================
+// ADAA Drive
+
+/*!
+ @class ADAADrive
+ @abstract drives stereo samples into a tanh, hard clip or asymmetric curve
+ @discussion rather than applying the curve to each sample, each output is the average of the
+             curve over the straight line bettween the last input and this one, the difference of
+             the curves antiderivative divided by the difference of the inputs. This averaging
+             removes most of the aliasing from the harmonics the curve adds above nyquist, at the
+             cost of half a sample of delay, so the voice does not need to be oversampled. The
+             tanh is the fast rational approximation x(27 + x^2)/(27 + 9x^2) which reaches 1 with
+             a flat slope at 3 and has an exact antiderivative, so the averaging stays exact
+ 
+ @namespace none
+ @updated 2026-10-19
+ */
+class ADAADrive
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    ADAADrive();
+    
+    /** Destructor*/
+    ~ADAADrive();
+    //==============================================================================
+    
+    //Curves the drive can use
+    enum DriveMode
+    {
+        off = 0,
+        tanhDrive,
+        hardClip,
+        asymmetric
+    };
+    
+    /**
+     * Set the curve of the drive
+     *
+     * @param newMode is one of the values in DriveMode
+     *
+    */
+    void setMode(int newMode);
+    
+    /**
+     * Gets the curve of the drive
+     *
+     * @return one of the values in DriveMode
+     *
+    */
+    int getMode() const { return mode; }
+    
+    /**
+     * Set the number of channels driven
+     *
+     * @param newNumChannels is the number of channels from 1 -> 8
+     *
+    */
+    void setNumChannels(int newNumChannels);
+    
+    /**
+     * Drives a block of samples in place
+     *
+     * @param channels is an array of a channel pointer for each channel set by setNumChannels, each holding numSamples samples
+     * @param numSamples is the number of samples to drive
+     * @param amountRamp is an array of numSamples drive amounts from 0 -> 1 to use for each sample,
+     *                   or nullptr to use amount for the whole block
+     * @param amount is the drive amount from 0 -> 1 used when there is no ramp, 0 is no gain into
+     *               the curve and 1 is 36dB
+     *
+    */
+    void process(float* const* channels, int numSamples, const float* amountRamp, float amount);
+    
+    /**
+     * Method to reset the last input of each channel
+     *
+    */
+    void reset();
+    
+private:
+    
+    /**
+     * Gets the gain into the curve for a drive amount
+     *
+     * @param amount is the drive amount from 0 -> 1
+     *
+     * @return the gain, 1 -> 63
+     *
+    */
+    static inline double calcGain(float amount)
+    {
+        return std::exp(gainRangeLog * (amount < 0.0f ? 0.0f : (amount > 1.0f ? 1.0f : amount)));
+    }
+    
+    /**
+     * The fast tanh approximation and its antiderivative, both odd so only the size of x is worked on
+     *
+    */
+    static inline double tanhCurve(double x)
+    {
+        const double size = std::abs(x);
+        const double y = size >= 3.0 ? 1.0 : size * (27.0 + size * size) / (27.0 + 9.0 * size * size);
+        return x < 0.0 ? -y : y;
+    }
+    static inline double tanhAntiderivative(double x)
+    {
+        const double size = std::abs(x);
+        if(size >= 3.0)
+            return tanhAntiderivativeAt3 + size - 3.0;
+        return size * size * (1.0 / 18.0) + (4.0 / 3.0) * std::log1p(size * size * (1.0 / 3.0));
+    }
+    
+    /**
+     * Gets the value of the curve
+     *
+     * @param x is the input to the curve
+     *
+    */
+    inline double curve(double x) const
+    {
+        switch(mode)
+        {
+            case hardClip:
+                return x < -1.0 ? -1.0 : (x > 1.0 ? 1.0 : x);
+            case asymmetric:    //The negative half saturates twice as early at half the level, which adds even harmonics
+                return x >= 0.0 ? tanhCurve(x) : 0.5 * tanhCurve(2.0 * x);
+            case tanhDrive:
+            default:
+                return tanhCurve(x);
+        }
+    }
+    
+    /**
+     * Gets the antiderivative of the curve, all are 0 at 0
+     *
+     * @param x is the input to the curve
+     *
+    */
+    inline double antiderivative(double x) const
+    {
+        switch(mode)
+        {
+            case hardClip:
+            {
+                const double size = std::abs(x);
+                return size <= 1.0 ? 0.5 * x * x : size - 0.5;
+            }
+            case asymmetric:
+                return x >= 0.0 ? tanhAntiderivative(x) : 0.25 * tanhAntiderivative(2.0 * x);
+            case tanhDrive:
+            default:
+                return tanhAntiderivative(x);
+        }
+    }
+    
+    //Maximum number of channels, enough for a 7.1 output
+    static constexpr int numChannels = 8;
+    
+    //Log of the gain at full drive, 36dB
+    static constexpr double gainRangeLog = 36.0 / 20.0 * 2.302585092994046;
+    
+    //Antiderivative of the tanh approximation where it reaches 1, 1/2 + 4/3 ln(4)
+    static constexpr double tanhAntiderivativeAt3 = 0.5 + 4.0 / 3.0 * 1.3862943611198906;
+    
+    //Below this difference bettween inputs the curve at the midpoint is used as the division loses its precision
+    static constexpr double minStep = 0.00001;
+    
+    //Curve in use and the number of channels driven
+    int mode = off;
+    int activeChannels = numChannels;
+    
+    //Last input into the curve of each channel and its antiderivative
+    double lastInput[numChannels] = {};
+    double lastAntiderivative[numChannels] = {};
+};
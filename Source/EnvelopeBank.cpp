@@ -0,0 +1,248 @@
+/*
+  ==============================================================================
+
+    EnvelopeBank.cpp
+    A bank of 8 ADSR envolopes stored side by side so that all of a voices
+    envolopes can be advanced together in one pass
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "EnvelopeBank.h"
+
+EnvelopeBank::EnvelopeBank()
+{
+    for(int i = 0; i < numLanes; ++i)   //Calculating intial coefficients from default parameters
+        recalculateCoeffs(i);
+}
+
+EnvelopeBank::~EnvelopeBank(){}
+
+void EnvelopeBank::setSampleRate(float newSampleRate)
+{
+    sampleRate = newSampleRate > 0 ? newSampleRate : 48000; //Check passed sample rate bigger than zero if not set as default value
+
+    for(int i = 0; i < numLanes; ++i)   //Coefficients depend on the sample rate so recalculate them
+        recalculateCoeffs(i);
+}
+
+void EnvelopeBank::setParameters(int lane, const ADSR::Parameters& newParams)
+{
+    laneParams[lane] = newParams;   //Store parameters, coefficients are updated at the next block
+    paramsChanged[lane] = true;
+    anyParamsChanged = true;
+}
+
+void EnvelopeBank::setCurve(int lane, float newCurve)
+{
+    newCurve = jlimit(0.0f, 1.0f, newCurve);
+    if(laneCurve[lane] != newCurve) //Only mark changed if the curve is different
+    {
+        laneCurve[lane] = newCurve;
+        paramsChanged[lane] = true;
+        anyParamsChanged = true;
+    }
+}
+
+void EnvelopeBank::applyPendingParameters()
+{
+    if(anyParamsChanged)    //Only check lanes if something has changed
+    {
+        for(int i = 0; i < numLanes; ++i)
+        {
+            if(paramsChanged[i])
+            {
+                recalculateCoeffs(i);
+                paramsChanged[i] = false;
+            }
+        }
+        anyParamsChanged = false;
+    }
+}
+
+float EnvelopeBank::calcCoeff(float timeSamples, float ratio)
+{
+    if(timeSamples <= 0.0f) //No time means the segment jumps straight to its target
+        return 0.0f;
+
+    return std::exp(-std::log((1.0f + ratio) / ratio) / timeSamples);
+}
+
+void EnvelopeBank::recalculateCoeffs(int lane)
+{
+    const ADSR::Parameters& p = laneParams[lane];
+    const float curve = laneCurve[lane];
+
+    //Ratios for how far past the end of each segment the curve aims, at a curve of 1
+    //these give the slightly rounded attack and steep decay and release of an analog envolope
+    const float attackRatio = std::pow(10.0f, 2.0f - 2.5f * curve);
+    const float decayReleaseRatio = std::pow(10.0f, 2.0f - 6.0f * curve);
+
+    const float attackSamples = p.attack * sampleRate;
+    const float decaySamples = p.decay * sampleRate;
+
+    sustainLevel[lane] = p.sustain;
+    hasAttack[lane] = attackSamples > 0.0f;
+    hasDecay[lane] = decaySamples > 0.0f && p.sustain < 1.0f;
+    afterAttackStage[lane] = hasDecay[lane] ? decayStage : sustainStage;
+
+    if(curve <= 0.0f)   //Linear segments
+    {
+        attackCoeff[lane] = 1.0f;
+        attackBase[lane] = hasAttack[lane] ? 1.0f / attackSamples : 0.0f;
+        decayCoeff[lane] = 1.0f;
+        decayBase[lane] = hasDecay[lane] ? -(1.0f - p.sustain) / decaySamples : 0.0f;
+    }
+    else                //Exponential segments aimed past their end point so they finish in time
+    {
+        attackCoeff[lane] = calcCoeff(attackSamples, attackRatio);
+        attackBase[lane] = (1.0f + attackRatio) * (1.0f - attackCoeff[lane]);
+        decayCoeff[lane] = calcCoeff(decaySamples, decayReleaseRatio);
+        decayBase[lane] = (p.sustain - decayReleaseRatio) * (1.0f - decayCoeff[lane]);
+    }
+
+    recalculateRelease(lane);
+}
+
+void EnvelopeBank::recalculateRelease(int lane)
+{
+    const float releaseSamples = laneParams[lane].release * sampleRate;
+    const float curve = laneCurve[lane];
+
+    if(releaseSamples <= 0.0f)  //No release, note off stops the lane straight away
+    {
+        releaseCoeff[lane] = 1.0f;
+        releaseBase[lane] = 0.0f;
+    }
+    else if(curve <= 0.0f)      //Linear release from the current level
+    {
+        releaseCoeff[lane] = 1.0f;
+        releaseBase[lane] = -level[lane] / releaseSamples;
+    }
+    else                        //Exponential release aimed just below 0
+    {
+        const float ratio = std::pow(10.0f, 2.0f - 6.0f * curve);
+        releaseCoeff[lane] = calcCoeff(releaseSamples, ratio);
+        releaseBase[lane] = -ratio * (1.0f - releaseCoeff[lane]);
+    }
+}
+
+void EnvelopeBank::noteOn()
+{
+    applyPendingParameters();   //Note start is a block boundary so use the latest parameters
+
+    for(int i = 0; i < numLanes; ++i)
+    {
+        if(hasAttack[i])        //Start at attack if there is one
+        {
+            stage[i] = attackStage;
+        }
+        else if(hasDecay[i])    //Otherwise jump to full level and decay
+        {
+            level[i] = 1.0f;
+            stage[i] = decayStage;
+        }
+        else                    //Otherwise go straight to sustain
+        {
+            stage[i] = sustainStage;
+        }
+    }
+}
+
+void EnvelopeBank::noteOff()
+{
+    applyPendingParameters();   //Note end is a block boundary so use the latest parameters
+
+    for(int i = 0; i < numLanes; ++i)
+    {
+        if(stage[i] != idleStage)
+        {
+            if(laneParams[i].release > 0.0f)    //Release from current level over the release time
+            {
+                recalculateRelease(i);
+                stage[i] = releaseStage;
+            }
+            else                                //No release so stop immediately
+            {
+                level[i] = 0.0f;
+                stage[i] = idleStage;
+            }
+        }
+    }
+}
+
+void EnvelopeBank::reset()
+{
+    for(int i = 0; i < numLanes; ++i)   //Set all lanes to idle
+    {
+        level[i] = 0.0f;
+        stage[i] = idleStage;
+    }
+}
+
+void EnvelopeBank::advance()
+{
+    //Every lane is computed every sample and the stage transitions are selected with masks,
+    //keeping this loop branch free so it maps onto vector compares and blends
+    for(int i = 0; i < numLanes; ++i)
+    {
+        const int s = stage[i];
+
+        //Lane masks are all ones when true so they can be used as vector blend masks
+        const int isAttack = -(s == attackStage);
+        const int isDecay = -(s == decayStage);
+        const int isSustain = -(s == sustainStage);
+        const int isRelease = -(s == releaseStage);
+
+        //Select the multiply and add of the current stage, idle holds at 0 and sustain holds at the sustain level.
+        //The stage masks are exclusive so they are summed as 0 or 1 weights rather than chained selects
+        const float wAttack = isAttack ? 1.0f : 0.0f;
+        const float wDecay = isDecay ? 1.0f : 0.0f;
+        const float wSustain = isSustain ? 1.0f : 0.0f;
+        const float wRelease = isRelease ? 1.0f : 0.0f;
+
+        const float coeff = wAttack * attackCoeff[i] + wDecay * decayCoeff[i] + wRelease * releaseCoeff[i];
+        const float base = wAttack * attackBase[i] + wDecay * decayBase[i] + wSustain * sustainLevel[i] + wRelease * releaseBase[i];
+
+        float next = level[i] * coeff + base;
+
+        //Masks for lanes that have reached the end of their stage
+        const int attackDone = isAttack & -(next >= 1.0f);
+        const int decayDone = isDecay & -(next <= sustainLevel[i]);
+        const int releaseDone = isRelease & -(next <= 0.0f);
+
+        next = attackDone ? 1.0f : next;
+        next = decayDone ? sustainLevel[i] : next;
+        next = releaseDone ? 0.0f : next;
+
+        int nextStage = attackDone ? afterAttackStage[i] : s;
+        nextStage = decayDone ? (int) sustainStage : nextStage;
+        nextStage = releaseDone ? (int) idleStage : nextStage;
+
+        level[i] = next;
+        stage[i] = nextStage;
+    }
+}
+
+void EnvelopeBank::getNextSamples(float* output)
+{
+    advance();  //Advance all lanes then copy out the levels
+
+    for(int i = 0; i < numLanes; ++i)
+        output[i] = level[i];
+}
+
+void EnvelopeBank::renderBlock(float* output, int numSamples)
+{
+    applyPendingParameters();   //Parameter changes only take effect at the start of a block
+
+    for(int sample = 0; sample < numSamples; ++sample)  //Write one frame of all lanes per sample
+        getNextSamples(output + sample * numLanes);
+}
+
+bool EnvelopeBank::isLaneActive(int lane) const
+{
+    return stage[lane] != idleStage;
+}
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    EnvelopeBank.h
+    A bank of 8 ADSR envolopes stored side by side so that all of a voices
+    envolopes can be advanced together in one pass
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+
+// =================================
+// =================================
+// Envelope Bank
+
+/*!
+ @class EnvelopeBank
+ @abstract 8 ADSR envolopes held in structure of arrays form and advanced together
+ @discussion every stage is a recursive multiply and add, level = level * coeff + base,
+             which gives linear segments when coeff is 1 and analog style exponential
+             segments otherwise. The lanes are stored in aligned arrays and stage changes
+             are worked out with per lane masks rather than branches so the per sample loop
+             has a fixed trip count that the compiler can vectorise to a single 8 float register.
+             Parameter changes are held until the next block boundary so the coefficients
+             are only recalculated once per block
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class EnvelopeBank
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    EnvelopeBank();
+    /** Destructor*/
+    ~EnvelopeBank();
+    //==============================================================================
+
+    //Number of envolopes held by the bank
+    static constexpr int numLanes = 8;
+
+    /**
+     * Sets the sample rate of all the envolopes
+     *
+     * @param newSampleRate is the sample rate in samples / s
+     *
+    */
+    void setSampleRate(float newSampleRate);
+
+    /**
+     * Sets the ADSR parameters of one envolope, applied at the start of the next block
+     *
+     * @param lane is the envolope to update
+     * @param newParams are the ADSR parameters with times in s and sustain from 0 -> 1
+     *
+    */
+    void setParameters(int lane, const ADSR::Parameters& newParams);
+
+    /**
+     * Sets the curve of one envolope, applied at the start of the next block
+     *
+     * @param lane is the envolope to update
+     * @param newCurve is the curve from 0 -> 1, 0 gives linear segments
+     *                 and 1 gives analog style exponential segments
+     *
+    */
+    void setCurve(int lane, float newCurve);
+
+    /**
+     * Starts the attack stage of every envolope
+     *
+    */
+    void noteOn();
+
+    /**
+     * Starts the release stage of every envolope
+     *
+    */
+    void noteOff();
+
+    /**
+     * Resets every envolope to idle with a level of 0
+     *
+    */
+    void reset();
+
+    /**
+     * Advances every envolope by one sample
+     *
+     * @param output is an array of numLanes values that returns the next envolope values
+     *
+    */
+    void getNextSamples(float* output);
+
+    /**
+     * Renders a block of envolope values for every envolope, applying any
+     * parameter changes made since the last block first
+     *
+     * @param output is an array of numSamples * numLanes values, interleaved so
+     *               output[sample * numLanes + lane] is the value of that lane
+     * @param numSamples is the number of samples to render
+     *
+    */
+    void renderBlock(float* output, int numSamples);
+
+    /**
+     * Checks if an envolope is active
+     *
+     * @param lane is the envolope to check
+     *
+     * @return true if the envolope is not idle
+     *
+    */
+    bool isLaneActive(int lane) const;
+
+private:
+
+    //Stages an envolope can be in
+    enum Stage
+    {
+        idleStage = 0,
+        attackStage,
+        decayStage,
+        sustainStage,
+        releaseStage
+    };
+
+    /**
+     * Recalculates the coefficients of any lane with changed parameters
+     *
+    */
+    void applyPendingParameters();
+
+    /**
+     * Calculates the stage coefficients of an envolope
+     *
+     * @param lane is the envolope to recalculate
+     *
+    */
+    void recalculateCoeffs(int lane);
+
+    /**
+     * Calculates the release coefficients of an envolope from its current level
+     *
+     * @param lane is the envolope to recalculate
+     *
+    */
+    void recalculateRelease(int lane);
+
+    /**
+     * Calculates the multiply coefficient of an exponential segment
+     *
+     * @param timeSamples is the length of the segment in samples
+     * @param ratio is how far past the segment end the curve is aimed, smaller is more curved
+     *
+     * @return the coefficient to multiply the level by each sample
+     *
+    */
+    static float calcCoeff(float timeSamples, float ratio);
+
+    /**
+     * Advances all lanes by one sample
+     *
+    */
+    void advance();
+
+    //Stored parameters of each lane
+    ADSR::Parameters laneParams[numLanes];
+    float laneCurve[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    bool paramsChanged[numLanes] = {true, true, true, true, true, true, true, true};
+    bool anyParamsChanged = true;
+
+    //Which lanes have an attack or decay stage to go through
+    bool hasAttack[numLanes];
+    bool hasDecay[numLanes];
+
+    //Per lane envolope state and stage coefficients, aligned so a whole array fits one register
+    alignas(32) int stage[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) int afterAttackStage[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) float level[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) float attackCoeff[numLanes] = {1, 1, 1, 1, 1, 1, 1, 1};
+    alignas(32) float attackBase[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) float decayCoeff[numLanes] = {1, 1, 1, 1, 1, 1, 1, 1};
+    alignas(32) float decayBase[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) float releaseCoeff[numLanes] = {1, 1, 1, 1, 1, 1, 1, 1};
+    alignas(32) float releaseBase[numLanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(32) float sustainLevel[numLanes] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+    float sampleRate = 48000;
+};
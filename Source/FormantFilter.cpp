@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    FormantFilter.cpp
+    Bank of parallel resonant band pass filters placed on the formants of
+    vowels, moved bettween vowels by the X and Y envolopes
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "FormantFilter.h"
+
+//First 4 formants of a sung male voice, level 1 is 0dB
+const double FormantFilter::vowelFormants[4][3][numFormants] =
+{
+    {{350.0, 600.0, 2400.0, 2675.0}, {40.0, 80.0, 100.0, 120.0}, {1.0, 0.1, 0.0251, 0.0398}},       //U
+    {{250.0, 1750.0, 2600.0, 3050.0}, {60.0, 90.0, 100.0, 120.0}, {1.0, 0.0316, 0.1585, 0.0794}},   //I
+    {{600.0, 1040.0, 2250.0, 2450.0}, {60.0, 70.0, 110.0, 120.0}, {1.0, 0.4467, 0.3548, 0.3548}},   //A
+    {{400.0, 1620.0, 2400.0, 2800.0}, {40.0, 80.0, 100.0, 120.0}, {1.0, 0.2512, 0.3548, 0.2512}}    //E
+};
+
+FormantFilter::FormantFilter(){}
+
+FormantFilter::~FormantFilter(){}
+
+void FormantFilter::setSampleRate(float newSampleRate)
+{
+    const double sampleRate = newSampleRate > 0 ? newSampleRate : 48000;   //Check passed sample rate bigger than zero if not set as default value
+    sampleTime = 1.0 / sampleRate;
+    maxFreq = 0.49 * sampleRate;
+    coeffsSet = false;  //The warped gains depend on the sample rate so jump to the new ones
+}
+
+void FormantFilter::setResonance(float newResonance)
+{
+    resonance = newResonance < 0.0f ? 0.0f : (newResonance > 1.0f ? 1.0f : newResonance);
+}
+
+void FormantFilter::setVowel(float x, float y)
+{
+    vowelX = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+    vowelY = y < 0.0f ? 0.0f : (y > 1.0f ? 1.0f : y);
+}
+
+void FormantFilter::resetFilter()
+{
+    for(int i = 0; i < 2; ++i)
+    {
+        for(int l = 0; l < numLanes; ++l)
+            state[i][l] = 0.0;
+    }
+}
+
+bool FormantFilter::isSilent(double level) const
+{
+    for(int i = 0; i < 2; ++i)
+    {
+        for(int l = 0; l < numLanes; ++l)
+        {
+            if(std::abs(state[i][l]) >= level)
+                return false;
+        }
+    }
+    return true;
+}
+
+void FormantFilter::calcLaneCoeffs(double* gains, double* damping, double* levels) const
+{
+    //Amount of each corner vowel from the bilinear interpolation of the position
+    const double cornerAmounts[4] = {(1.0 - vowelX) * (1.0 - vowelY), vowelX * (1.0 - vowelY), (1.0 - vowelX) * vowelY, vowelX * vowelY};
+    
+    //Resonance narrows the bandwidths
+    const double bandwidthScale = 1.0 - 0.8 * resonance;
+    
+    for(int f = 0; f < numFormants; ++f)
+    {
+        double values[3] = {0.0, 0.0, 0.0};
+        for(int corner = 0; corner < 4; ++corner)
+        {
+            for(int v = 0; v < 3; ++v)
+                values[v] += cornerAmounts[corner] * vowelFormants[corner][v][f];
+        }
+        
+        const double freq = values[0] > maxFreq ? maxFreq : values[0];
+        const double gain = std::tan(PI * freq * sampleTime);
+        const double bandwidthDamping = values[1] * bandwidthScale / freq;  //Damping is 1/Q, the bandwidth over the centre frequency
+        const double k = bandwidthDamping < 0.02 ? 0.02 : bandwidthDamping;
+        
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            gains[f * numChannels + ch] = gain;
+            damping[f * numChannels + ch] = k;
+            levels[f * numChannels + ch] = values[2];
+        }
+    }
+}
+
+void FormantFilter::process(float* const* channels, int numSamples)
+{
+    if(numSamples <= 0)
+        return;
+    
+    float* left = channels[0];
+    float* right = channels[1];
+    
+    //Values for the vowel at the end of the block and how much they move each sample
+    alignas(64) double endGain[numLanes], endDamping[numLanes], endLevel[numLanes];
+    calcLaneCoeffs(endGain, endDamping, endLevel);
+    if(!coeffsSet)
+    {
+        for(int l = 0; l < numLanes; ++l)
+        {
+            laneGain[l] = endGain[l];
+            laneDamping[l] = endDamping[l];
+            laneLevel[l] = endLevel[l];
+        }
+        coeffsSet = true;
+    }
+    
+    alignas(64) double gainInc[numLanes], dampingInc[numLanes], levelInc[numLanes];
+    bool moving = false;
+    for(int l = 0; l < numLanes; ++l)
+    {
+        gainInc[l] = (endGain[l] - laneGain[l]) / numSamples;
+        dampingInc[l] = (endDamping[l] - laneDamping[l]) / numSamples;
+        levelInc[l] = (endLevel[l] - laneLevel[l]) / numSamples;
+        moving = moving || gainInc[l] != 0.0 || dampingInc[l] != 0.0 || levelInc[l] != 0.0;
+    }
+    
+    //Working from locals so the states stay in registers through the loop
+    alignas(64) double ic1[numLanes], ic2[numLanes];
+    alignas(64) double a1[numLanes], a2[numLanes], a3[numLanes], outGain[numLanes];
+    for(int l = 0; l < numLanes; ++l)
+    {
+        ic1[l] = state[0][l];
+        ic2[l] = state[1][l];
+        
+        //Gains of the feedback loop solved for the current input, the band pass is scaled by the damping for unity gain at the centre
+        a1[l] = 1.0 / (1.0 + laneGain[l] * (laneGain[l] + laneDamping[l]));
+        a2[l] = laneGain[l] * a1[l];
+        a3[l] = laneGain[l] * a2[l];
+        outGain[l] = laneDamping[l] * laneLevel[l];
+    }
+    
+    for(int i = 0; i < numSamples; ++i)
+    {
+        if(moving)  //Moving bettween vowels, the values are worked out from the start of the block for every lane at once
+        {
+            const double steps = i + 1;
+            for(int l = 0; l < numLanes; ++l)
+            {
+                const double g = laneGain[l] + gainInc[l] * steps;
+                const double k = laneDamping[l] + dampingInc[l] * steps;
+                a1[l] = 1.0 / (1.0 + g * (g + k));
+                a2[l] = g * a1[l];
+                a3[l] = g * a2[l];
+                outGain[l] = k * (laneLevel[l] + levelInc[l] * steps);
+            }
+        }
+        
+        //Every formant of both channels in one fixed length loop so each line is a vector operation
+        alignas(64) double output[numLanes];
+        for(int l = 0; l < numLanes; ++l)
+        {
+            const double v0 = (l & 1) ? right[i] : left[i];
+            const double v3 = v0 - ic2[l];
+            const double v1 = a1[l] * ic1[l] + a2[l] * v3;            //Band pass
+            const double v2 = ic2[l] + a2[l] * ic1[l] + a3[l] * v3;   //Low pass
+            ic1[l] = 2.0 * v1 - ic1[l];
+            ic2[l] = 2.0 * v2 - ic2[l];
+            output[l] = outGain[l] * v1;
+        }
+        
+        //Summing the formants of each channel
+        double sum[numChannels] = {0.0, 0.0};
+        for(int f = 0; f < numFormants; ++f)
+        {
+            sum[0] += output[f * numChannels];
+            sum[1] += output[f * numChannels + 1];
+        }
+        left[i] = (float) sum[0];
+        right[i] = (float) sum[1];
+    }
+    
+    for(int l = 0; l < numLanes; ++l)   //Storing the states for the next block, flushing states too small to hear, and finishing on the end values
+    {
+        state[0][l] = Denormals::flush(ic1[l]);
+        state[1][l] = Denormals::flush(ic2[l]);
+        laneGain[l] = endGain[l];
+        laneDamping[l] = endDamping[l];
+        laneLevel[l] = endLevel[l];
+    }
+}
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    FormantFilter.h
+    Bank of parallel resonant band pass filters placed on the formants of
+    vowels, moved bettween vowels by the X and Y envolopes
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>    //Including cmath for maths functions
+#include "Denormals.h"
+
+// =================================
+// =================================
+// Formant Filter
+
+/*!
+ @class FormantFilter
+ @abstract a vowel filter made of parallel band pass filters for stereo samples
+ @discussion each formant is a zero delay feedback state variable band pass and the formants
+             are summed to make the output. The vowel is a position on a square with a vowel
+             at each corner, U at (0, 0), I at (1, 0), A at (0, 1) and E at (1, 1), so the
+             side from U to A passes through O. The formant frequencies, bandwidths and levels
+             are interpolated from the corners. The states of every formant of both channels are
+             stored as one row of lanes, [formant][channel], so all the band passes are worked
+             out together in each line of the sample loop rather than one filter after another
+ 
+ @namespace none
+ @updated 2026-10-19
+ */
+class FormantFilter
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    FormantFilter();
+    
+    /** Destructor*/
+    ~FormantFilter();
+    //==============================================================================
+    
+    //Number of formants of each vowel
+    static constexpr int numFormants = 4;
+    
+    /**
+     * Set the sample rate of the filter
+     *
+     * @param newSampleRate is the updated sample rate
+     *
+    */
+    void setSampleRate(float newSampleRate);
+    
+    /**
+     * Set how sharp the formants are
+     *
+     * @param newResonance is the resonance from 0 -> 1, 0 uses the bandwidths of the vowels
+     *                     and 1 makes them 5 times narrower
+     *
+    */
+    void setResonance(float newResonance);
+    
+    /**
+     * Set the vowel the filter moves to over the next block
+     *
+     * @param x is the position from 0 -> 1 from the back vowels U and A to the front vowels I and E
+     * @param y is the position from 0 -> 1 from the closed vowels U and I to the open vowels A and E
+     *
+    */
+    void setVowel(float x, float y);
+    
+    /**
+     * Filters a block of stereo samples in place, the formants move from where the last block
+     * finished to the vowel that has been set across the block
+     *
+     * @param channels is an array of 2 channel pointers, left and right, each holding numSamples samples
+     * @param numSamples is the number of samples to filter
+     *
+    */
+    void process(float* const* channels, int numSamples);
+    
+    /**
+     * Method to reset the band pass states
+     *
+    */
+    void resetFilter();
+    
+    /**
+     * Checks if the filter has no tail left to output
+     *
+     * @param level is the level below which a state counts as silent
+     *
+     * @return true if every band pass state is smaller than level
+     *
+    */
+    bool isSilent(double level) const;
+    
+private:
+    
+    /**
+     * Calculates the gain, damping and level of every lane for the set vowel
+     *
+     * @param gains returns the frequency warped integrator gain of each lane
+     * @param damping returns the damping of each lane which is the bandwidth over the frequency
+     * @param levels returns the level of each lane
+     *
+    */
+    void calcLaneCoeffs(double* gains, double* damping, double* levels) const;
+    
+    //Maximum number of channels and the lanes processed together, lane = formant * numChannels + channel
+    static constexpr int numChannels = 2;
+    static constexpr int numLanes = numFormants * numChannels;
+    
+    //Frequencies in Hz, bandwidths in Hz and levels of the formants of the vowel at each corner as [corner][value][formant]
+    static const double vowelFormants[4][3][numFormants];
+    
+    //Integrator states of each lane as [integrator][lane]
+    alignas(64) double state[2][numLanes] = {};
+    
+    //Gain, damping and level of each lane the last block finished on
+    alignas(64) double laneGain[numLanes] = {};
+    alignas(64) double laneDamping[numLanes] = {};
+    alignas(64) double laneLevel[numLanes] = {};
+    
+    //True once the lane values have been worked out, the first block starts on the set vowel
+    bool coeffsSet = false;
+    
+    //Vowel position and resonance
+    float vowelX = 0.0f;
+    float vowelY = 1.0f;
+    float resonance = 0.0f;
+    
+    //Sample time in s and the highest formant frequency allowed at this sample rate
+    double sampleTime = 1.0/48000;
+    double maxFreq = 0.49 * 48000;
+    
+    //Pi to be used in calculations
+    double PI = 3.14159265358979;
+};
@@ -3,7 +3,8 @@
 
     MyIIRFilter.cpp
     This class creates a filter to filter incoming samples using a IIR filter
-    Filters can be -12db/oct or -24db/oct, high pass or low pass
+    Filters can be -12db/oct or -24db/oct, high pass or low pass, made from
+    one or two 2nd order sections
     Created: 15 Apr 2020
     Author:  B159113
 
@@ -12,6 +13,105 @@
 
 #include "MyIIRFilter.h"
 #include <iostream>
+#include <map>
+#include <mutex>
+
+//Butterworth coefficients of the sections, the 2nd order section then the two sections of the 4th order filter
+const double IIRCoeffTable::dampingCoeffs[numDampings] = {2 * 1.4142135623730951, 2 * 1.8478, 2 * 0.7654};
+
+IIRCoeffTable::IIRCoeffTable(float sampleRate)
+{
+    const double PI = 3.14159265358979;
+    const double maxFreq = 0.49 * sampleRate;   //Table stops just below nyquist
+    
+    numPoints = (int) (std::log2(maxFreq / minFreq) * pointsPerOctave) + 1;
+    table.resize(2 * numDampings * numPoints * 5);
+    
+    for(int highPass = 0; highPass < 2; ++highPass)     //Calculate every section type at every point
+    {
+        for(int d = 0; d < numDampings; ++d)
+        {
+            for(int i = 0; i < numPoints; ++i)
+            {
+                double freq = minFreq * std::exp2((double) i / pointsPerOctave);
+                double wp = 2 * tan(freq * PI / sampleRate);    //Frequency warped cut off of this point
+                calcSectionCoeffs(wp, highPass == 1, dampingCoeffs[d], &table[((highPass * numDampings + d) * numPoints + i) * 5]);
+            }
+        }
+    }
+}
+
+IIRCoeffTable::~IIRCoeffTable(){}
+
+std::shared_ptr<const IIRCoeffTable> IIRCoeffTable::getTable(float sampleRate)
+{
+    //Tables are kept while any filter uses them so all the voices share one table
+    static std::mutex tableLock;
+    static std::map<float, std::weak_ptr<const IIRCoeffTable>> tables;
+    
+    std::lock_guard<std::mutex> lock(tableLock);
+    std::shared_ptr<const IIRCoeffTable> sharedTable = tables[sampleRate].lock();
+    if(sharedTable == nullptr)  //Create the table if there isn't one for the sample rate
+    {
+        sharedTable = std::make_shared<const IIRCoeffTable>(sampleRate);
+        tables[sampleRate] = sharedTable;
+    }
+    return sharedTable;
+}
+
+void IIRCoeffTable::calcSectionCoeffs(double wp, bool highPass, double dampingCoeff, double* coeffs)
+{
+    double wpSquared = wp * wp;             //Calculations required for the difference equations
+    double wpSquaredp4 = wpSquared + 4;
+    double b = dampingCoeff * wp;
+    
+    double outputCoeff = wpSquaredp4 + b;   //Coefficient of the current output, everything is divided by this
+    
+    if(highPass)    //Calculate input part for high pass if in high pass mode
+    {
+        coeffs[0] = 4 / outputCoeff;
+        coeffs[1] = -8 / outputCoeff;
+        coeffs[2] = coeffs[0];
+    }
+    else //Calculate input part of the diffence equation
+    {
+        coeffs[0] = wpSquared / outputCoeff;
+        coeffs[1] = 2 * coeffs[0];
+        coeffs[2] = coeffs[0];
+    }
+    
+    //Calculate output part of difference equation, same for high pass and low pass
+    coeffs[3] = (2 * wpSquared - 8) / outputCoeff;
+    coeffs[4] = (wpSquaredp4 - b) / outputCoeff;
+}
+
+bool IIRCoeffTable::lookupCoeffs(float cutOffFreq, bool highPass, bool minus24DbMode, double (*coeffs)[5]) const
+{
+    float pos = std::log2(cutOffFreq * (1.0f / (float) minFreq)) * pointsPerOctave;  //Position of the cut off in the table
+    
+    if(!(pos >= 0.0f) || pos >= numPoints - 1)   //Outside the table
+        return false;
+    
+    int index = (int) pos;
+    double frac = pos - index;
+    
+    //The -12dB/oct filter uses the first damping and the -24dB/oct filter the next two
+    const int firstDamping = minus24DbMode ? 1 : 0;
+    const int sections = minus24DbMode ? 2 : 1;
+    
+    for(int s = 0; s < sections; ++s)
+    {
+        const double* lower = &table[((highPass ? numDampings : 0) + firstDamping + s) * numPoints * 5 + index * 5];
+        const double* upper = lower + 5;
+        
+        for(int i = 0; i < 5; ++i)  //Interpolate bettween the two nearest points
+            coeffs[s][i] = lower[i] + (upper[i] - lower[i]) * frac;
+    }
+    
+    return true;
+}
+
+//==============================================================================
 
 MyIIRFilter::MyIIRFilter()  //Constructor
 {}
@@ -20,6 +120,23 @@ MyIIRFilter::~MyIIRFilter(){}   //Destructor
 void MyIIRFilter::setSampleRate(float newSampleRate)
 {
     sampleTime = 1/newSampleRate;   //updating sample time based on input sample rate
+    coeffTable = IIRCoeffTable::getTable(newSampleRate);   //Getting the coefficient table for the sample rate
+    calcDiffEqnCoeffs();            //Coefficients depend on the sample rate so recalculate them
+}
+
+void MyIIRFilter::setCoeffMode(int newCoeffMode)
+{
+    coeffMode = newCoeffMode;
+}
+
+void MyIIRFilter::setNumChannels(int newNumChannels)
+{
+    newNumChannels = newNumChannels < 2 ? 1 : numChannels;  //Anything but mono filters both channels
+    if(activeChannels != newNumChannels)
+    {
+        activeChannels = newNumChannels;
+        resetFilter();  //A channel that is switched back on would start with an old tail
+    }
 }
 
 
@@ -28,8 +145,6 @@ bool MyIIRFilter::setCutOffFreq(float newCutoffFreq)
     if(cutOffFreq != newCutoffFreq)             //check cut off frequency changed
     {
         cutOffFreq = newCutoffFreq;             //Update cut off
-        wp = 2 * tan(cutOffFreq * PI * sampleTime);     //Calculate freuqncy warped cut-off so bilinear transform can be used
-
         return true;                        //Return true to show that the value has changed
     }
     
@@ -38,120 +153,200 @@ bool MyIIRFilter::setCutOffFreq(float newCutoffFreq)
 }
 
 
-void MyIIRFilter::calcDiffEqnCoeffs(bool typeChanged)
+void MyIIRFilter::calcCoeffs(float freq, double (*coeffs)[5])
 {
-    double wpSquared = wp * wp;             //Calculations required for the difference equations
-    double wpSquaredp4 = wpSquared + 4;
+    //Use the table if in table mode and the cut off is in its range
+    if(coeffMode == tableCoeffs && coeffTable != nullptr && coeffTable -> lookupCoeffs(freq, type, minus24dbMode, coeffs))
+        return;
     
-    if(minus24dbMode)                   //If in -24Db/Octave mode calculate 4th order difference equation coeffs
+    double wp = 2 * tan(freq * PI * sampleTime);     //Calculate freuqncy warped cut-off so bilinear transform can be used
+    
+    if(minus24dbMode)   //If in -24Db/Octave mode use two sections, the more damped one first
     {
-        double wps4Squared = wpSquaredp4 * wpSquaredp4;
-        double b1 = fourthOrderCoeff[0] * wp;
-        double b2 = fourthOrderCoeff[1] * wp;
-        double b1b2 = b1 * b2;
-        double b1pb2 = b1 + b2;
-        double bco = 2 * wpSquared -8;
+        IIRCoeffTable::calcSectionCoeffs(wp, type, IIRCoeffTable::dampingCoeffs[1], coeffs[0]);
+        IIRCoeffTable::calcSectionCoeffs(wp, type, IIRCoeffTable::dampingCoeffs[2], coeffs[1]);
+    }
+    else    //Otherwise one 2nd order section
+    {
+        IIRCoeffTable::calcSectionCoeffs(wp, type, IIRCoeffTable::dampingCoeffs[0], coeffs[0]);
+    }
+}
 
-        if(type)                //If high pass use high pass coeffs
-        {
-            if(typeChanged) //Only update if type or order recently changed for high pass
-            {
-                differenceEQNCoeffs[0][0] = 16;
-                differenceEQNCoeffs[0][1] = -64;
-                differenceEQNCoeffs[0][2] = 96;
-                differenceEQNCoeffs[0][3] = -64;
-                differenceEQNCoeffs[0][4] = 16;
-            }
-        }
-        else        //If low pass calc low pass coedds
-        {
-            differenceEQNCoeffs[0][0] = wpSquared * wpSquared;
-            differenceEQNCoeffs[0][1] = 4 * differenceEQNCoeffs[0][0];
-            differenceEQNCoeffs[0][2] = 6 * differenceEQNCoeffs[0][0];
-            differenceEQNCoeffs[0][3] = differenceEQNCoeffs[0][1];
-            differenceEQNCoeffs[0][4] = differenceEQNCoeffs[0][0];
-        }
-        
-        //Calculate output part of the difference equation, same for both high pass and low pass
+void MyIIRFilter::calcDiffEqnCoeffs()
+{
+    calcCoeffs(cutOffFreq, differenceEQNCoeffs);
+}
+
+
+
+float MyIIRFilter::processNextSample(float nextSample) //Process the next sample, mono samples use the left channel states
+{
+    double sample = nextSample;
+    
+    for(int i = 0; i < numSections; ++i)    //Pass the sample through each section in turn
+    {
+        const double* coeffs = differenceEQNCoeffs[i];
+        double (*state)[numChannels] = sectionState[i];
         
-        double firstAndLast = wps4Squared + b1b2;
-        double gainsumthingy = b1pb2 * wpSquaredp4;
-        double middleVals = bco * 2 * wpSquaredp4;
-        double middleVals2 = bco * b1pb2;
+        double output = coeffs[0] * sample + state[0][0];                    //Output is the input plus the stored state
+        state[0][0] = coeffs[1] * sample - coeffs[3] * output + state[1][0];  //Update the states for the next samples
+        state[1][0] = coeffs[2] * sample - coeffs[4] * output;
         
-        differenceEQNCoeffs[1][0] = -firstAndLast + gainsumthingy;
-        differenceEQNCoeffs[1][1] = -middleVals + middleVals2;
-        differenceEQNCoeffs[1][2] = -2*wps4Squared + 2*b1b2 - bco * bco;
-        differenceEQNCoeffs[1][3] = -middleVals - middleVals2;
-        differenceEQNCoeffs[1][4] = firstAndLast + gainsumthingy;
+        sample = output;
+    }
+    
+    return sample;  //Returning the output
+}
+
+void MyIIRFilter::processNextFrame(float* samples) //Process the next stereo frame
+{
+    alignas(16) double frame[numChannels] = {samples[0], samples[1]};
+    
+    for(int i = 0; i < numSections; ++i)    //Pass the frame through each section in turn
+    {
+        const double b0 = differenceEQNCoeffs[i][0], b1 = differenceEQNCoeffs[i][1], b2 = differenceEQNCoeffs[i][2];
+        const double a1 = differenceEQNCoeffs[i][3], a2 = differenceEQNCoeffs[i][4];
+        double (*state)[numChannels] = sectionState[i];
         
+        //Each line works on both channels with the same coefficients so it maps onto one vector operation
+        alignas(16) double output[numChannels];
+        for(int ch = 0; ch < numChannels; ++ch)
+            output[ch] = b0 * frame[ch] + state[0][ch];
+        for(int ch = 0; ch < numChannels; ++ch)
+            state[0][ch] = b1 * frame[ch] - a1 * output[ch] + state[1][ch];
+        for(int ch = 0; ch < numChannels; ++ch)
+            state[1][ch] = b2 * frame[ch] - a2 * output[ch];
+        for(int ch = 0; ch < numChannels; ++ch)
+            frame[ch] = output[ch];
+    }
+    
+    samples[0] = frame[0];  //Returning the outputs
+    samples[1] = frame[1];
+}
+
+void MyIIRFilter::processBlock(float* const* channels, int numSamples, const float* cutoffRamp)
+{
+    if(numSamples <= 0)
+        return;
+    
+    double coeffs[maxSections][5];
+    for(int s = 0; s < numSections; ++s)    //Starting from the current coefficients
+    {
+        for(int c = 0; c < 5; ++c)
+            coeffs[s][c] = differenceEQNCoeffs[s][c];
     }
-    else    //Otherwise calculate 2nd order differnce equation
+    
+    if(cutoffRamp == nullptr)   //Cut off is not moving so the coefficients stay the same for the block
     {
-        double b = secondOrderCoeff * wp;
-        if(type)    //Calculate input part for high pass if in high pass mode
-        {
-            if(typeChanged) //Only update if type or order recently changed for high pass
-            {
-                differenceEQNCoeffs[0][0] = 4;
-                differenceEQNCoeffs[0][1] = -8;
-                differenceEQNCoeffs[0][2] = 4;
-            }
-        }
-        else //Calculate input part of the diffence equation
+        if(activeChannels == 1)
+            processFrames<1>(channels, numSamples, coeffs, nullptr, nullptr);
+        else
+            processFrames<2>(channels, numSamples, coeffs, nullptr, nullptr);
+    }
+    else if(coeffMode == blockInterpolatedCoeffs)   //Calculate the coefficients at the end of the block and interpolate to them
+    {
+        setFilterCutOffFreq(cutoffRamp[numSamples - 1]);
+        
+        double coeffIncrements[maxSections][5];
+        for(int s = 0; s < numSections; ++s)
         {
-            differenceEQNCoeffs[0][0] = wpSquared;
-            differenceEQNCoeffs[0][1] = 2 * differenceEQNCoeffs[0][0];
-            differenceEQNCoeffs[0][2] = differenceEQNCoeffs[0][0];
+            for(int c = 0; c < 5; ++c)
+                coeffIncrements[s][c] = (differenceEQNCoeffs[s][c] - coeffs[s][c]) / numSamples;
         }
         
-        //Calculate output part of difference equation, same for high pass and low pass
+        if(activeChannels == 1)
+            processFrames<1>(channels, numSamples, coeffs, coeffIncrements, nullptr);
+        else
+            processFrames<2>(channels, numSamples, coeffs, coeffIncrements, nullptr);
+    }
+    else    //Otherwise the coefficients are calculated for each sample
+    {
+        if(activeChannels == 1)
+            processFrames<1>(channels, numSamples, coeffs, nullptr, cutoffRamp);
+        else
+            processFrames<2>(channels, numSamples, coeffs, nullptr, cutoffRamp);
         
-        differenceEQNCoeffs[1][0] = (-wpSquaredp4 + b);
-        differenceEQNCoeffs[1][1] = -2 * wpSquared + 8;
-        differenceEQNCoeffs[1][2] = wpSquaredp4 + b;
+        cutOffFreq = cutoffRamp[numSamples - 1];    //Keeping the last cut off and its coefficients
+        for(int s = 0; s < numSections; ++s)
+        {
+            for(int c = 0; c < 5; ++c)
+                differenceEQNCoeffs[s][c] = coeffs[s][c];
+        }
     }
-
 }
 
-
-
-float MyIIRFilter::processNextSample(float nextSample) //Process the next sample
+template <int NumChannels>
+void MyIIRFilter::processFrames(float* const* channels, int numSamples, double (*coeffs)[5], const double (*coeffIncrements)[5], const float* cutoffRamp)
 {
-    prevInput[delayLinePos] = nextSample;   //update previous input
-    
-    int delayDiff = delayLinePos - order;   //Calulate the latest sample position
-    
-    double output = 0;  //Initialise output as 0
+    //Copy the coefficients and states locally so they can stay in registers for the whole block
+    const int sections = numSections;
+    double localCoeffs[maxSections][5];
+    alignas(16) double state[maxSections][2][numChannels];
+    for(int s = 0; s < sections; ++s)
+    {
+        for(int c = 0; c < 5; ++c)
+            localCoeffs[s][c] = coeffs[s][c];
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            state[s][0][ch] = sectionState[s][0][ch];
+            state[s][1][ch] = sectionState[s][1][ch];
+        }
+    }
     
-    for(int i = 0 ; i < order+1; ++i)
+    //Each type of coefficient update has its own loop so the constant and interpolated loops have no calls in them
+    if(cutoffRamp != nullptr)
     {
-        int pos = delayDiff + i;
-        if(pos < 0)
+        float lastCutOff = cutOffFreq;
+        for(int i = 0; i < numSamples; ++i)
         {
-            pos = pos + 10;
-            
+            if(cutoffRamp[i] != lastCutOff)  //Calculate this samples coefficients if the cut off moved
+            {
+                lastCutOff = cutoffRamp[i];
+                calcCoeffs(lastCutOff, localCoeffs);
+            }
+            filterFrame<NumChannels>(channels, i, localCoeffs, state, sections);
+        }
+    }
+    else if(coeffIncrements != nullptr)
+    {
+        //Each samples coefficients are worked out from the start of the block rather than
+        //added to the last samples so there is no chain of additions from sample to sample
+        double sampleCoeffs[maxSections][5];
+        for(int i = 0; i < numSamples; ++i)
+        {
+            const double steps = i + 1;
+            for(int s = 0; s < sections; ++s)
+            {
+                for(int c = 0; c < 5; ++c)
+                    sampleCoeffs[s][c] = localCoeffs[s][c] + coeffIncrements[s][c] * steps;
+            }
+            filterFrame<NumChannels>(channels, i, sampleCoeffs, state, sections);
         }
         
-        output = output + differenceEQNCoeffs[0][i] * prevInput[pos]; //Calculate input part of the equations
-        
-        if(i < order)   //is one less than the order
+        for(int s = 0; s < sections; ++s)   //Ending on the coefficients of the last sample
         {
-            output = output + differenceEQNCoeffs[1][i] * prevOutput[pos]; //Calculate output part of the equations
+            for(int c = 0; c < 5; ++c)
+                localCoeffs[s][c] = sampleCoeffs[s][c];
         }
     }
-    
-    output = output / differenceEQNCoeffs[1][order];    //Dividing output by output coeff
-    
-    prevOutput[delayLinePos] = output;  //Updating the previous output
-    
-    delayLinePos++;         //Updating the delay line position
-    if(delayLinePos > 9)
+    else
     {
-        delayLinePos = 0;
+        for(int i = 0; i < numSamples; ++i)
+            filterFrame<NumChannels>(channels, i, localCoeffs, state, sections);
     }
     
-    return output;  //Returning the output
+    //Storing the coefficients and states for the next block, states decaying to nothing after the
+    //input goes silent are flushed to 0 here rather than drifting into the denormal range
+    for(int s = 0; s < sections; ++s)
+    {
+        for(int c = 0; c < 5; ++c)
+            coeffs[s][c] = localCoeffs[s][c];
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            sectionState[s][0][ch] = Denormals::flush(state[s][0][ch]);
+            sectionState[s][1][ch] = Denormals::flush(state[s][1][ch]);
+        }
+    }
 }
 
 
@@ -160,7 +355,12 @@ bool MyIIRFilter::setOrder(bool newMinus24DbMode)   //Setting filter order
     if(minus24dbMode != newMinus24DbMode)   //If the mode changed
     {
         minus24dbMode = newMinus24DbMode;   //Update mode
-        order = minus24dbMode ? 4 : 2;      //Update the order based on mode selected
+        numSections = minus24dbMode ? 2 : 1;    //Update the number of sections based on mode selected
+        for(int ch = 0; ch < numChannels; ++ch) //Clear the second section so it starts from silence when it is switched in
+        {
+            sectionState[1][0][ch] = 0.0;
+            sectionState[1][1][ch] = 0.0;
+        }
         return true;                        //Return that value has changed
     }
     return false;                           //Return that the value hasn't changed
@@ -180,14 +380,16 @@ bool MyIIRFilter::setType(bool highPassMode)    // Setting filter type
 void MyIIRFilter::setFilterParams(float newCutOffFreq, bool newMinus24DbMode, bool highPassMode) //Setting all filter params
 {
     bool updateOrderType = false;               //Parm to check if the type or order has changed
-    if(setType(highPassMode) || setOrder(newMinus24DbMode)) //Check if type or order have changed
+    bool typeChanged = setType(highPassMode);   //Both set first so a change of type doesn't skip the order
+    bool orderChanged = setOrder(newMinus24DbMode);
+    if(typeChanged || orderChanged) //Check if type or order have changed
     {
         updateOrderType = true;
     }
     
     if(setCutOffFreq(newCutOffFreq) || updateOrderType) //If order type or cutoff frequency changed recalculate the difference equations
     {
-        calcDiffEqnCoeffs(updateOrderType);
+        calcDiffEqnCoeffs();
     }
 }
 
@@ -200,7 +402,7 @@ void MyIIRFilter::setFilterType(bool highPassMode)  //Setting the filter type
 {
     if(setType(highPassMode))       //Check if type changed
     {
-        calcDiffEqnCoeffs(true);    //If it has changed update the difference eqns
+        calcDiffEqnCoeffs();        //If it has changed update the difference eqns
     }
 }
 
@@ -208,7 +410,7 @@ void MyIIRFilter::setFilterOrder(float newMinus24DbMode)    //Setting filter ord
 {
     if(setOrder(newMinus24DbMode))  //Check if order changed
     {
-        calcDiffEqnCoeffs(true);    //If it has changed update the difference eqns
+        calcDiffEqnCoeffs();        //If it has changed update the difference eqns
     }
 }
 
@@ -216,15 +418,31 @@ void MyIIRFilter::setFilterCutOffFreq(float newCutOffFreq)  //Setting cutoff fre
 {
     if(setCutOffFreq(newCutOffFreq))    //Check if cut off frequency changed
     {
-        calcDiffEqnCoeffs(false);       //If changed calculate the difference equations
+        calcDiffEqnCoeffs();            //If changed calculate the difference equations
     }
 }
 
 void MyIIRFilter::resetFilter() //Reset the filer
 {
-    for(int i = 0; i < 10; ++i) //Loop through all the previous stored parameters and set them to 0
+    for(int i = 0; i < maxSections; ++i) //Loop through all the section states and set them to 0
     {
-        prevInput[i] = 0.0f;
-        prevOutput[i] = 0.0f;
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            sectionState[i][0][ch] = 0.0;
+            sectionState[i][1][ch] = 0.0;
+        }
+    }
+}
+
+bool MyIIRFilter::isSilent(double level) const
+{
+    for(int i = 0; i < numSections; ++i) //Only the sections and channels in use can hold a tail
+    {
+        for(int ch = 0; ch < activeChannels; ++ch)
+        {
+            if(std::abs(sectionState[i][0][ch]) >= level || std::abs(sectionState[i][1][ch]) >= level)
+                return false;
+        }
     }
+    return true;
 }
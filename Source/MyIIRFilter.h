@@ -3,8 +3,10 @@
 
     myIIRFilter.h
     This class creates a filter to filter incoming samples,
-    The file contains 2 classes the myIIRFilter that filters mono samples and
-    StereoIIRFilters that can filter stereo samples using the myIIRFilter class
+    The file contains 3 classes the IIRCoeffTable that stores precalculated filter
+    coefficients, the myIIRFilter that filters mono or stereo samples with one set
+    of coefficients and StereoIIRFilters that can filter stereo samples using the
+    myIIRFilter class
     Created: 15 Apr 2020
     Author:  B159113
 
@@ -13,6 +15,95 @@
 
 #pragma once
 #include <cmath>    //Including cmath for maths functions
+#include <memory>   //Including memory for sharing coefficient tables
+#include <vector>   //Including vector for storing the coefficient tables
+#include "Denormals.h"
+
+
+// =================================
+// =================================
+// IIR Coeff Table
+
+/*!
+ @class IIRCoeffTable
+ @abstract a table of 2nd order section coefficients for a range of cut off frequencies at one sample rate
+ @discussion the cut offs are spaced evenly in log frequency and the coefficients bettween
+             two points are linearly interpolated, which replaces the tan and divisions of
+             calculating the coefficients while the cut off is swept. One table is shared by
+             every filter running at the same sample rate
+ 
+ @namespace none
+ @updated 2026-10-19
+ */
+class IIRCoeffTable
+{
+public:
+    //==============================================================================
+    /**
+     * Constructor, calculates the table for a sample rate
+     *
+     * @param sampleRate is the sample rate the table is calculated for
+     *
+    */
+    IIRCoeffTable(float sampleRate);
+    
+    /** Destructor*/
+    ~IIRCoeffTable();
+    //==============================================================================
+    
+    //Butterworth coefficients of the sections, the 2nd order section then the two sections of the 4th order filter
+    static constexpr int numDampings = 3;
+    static const double dampingCoeffs[numDampings];
+    
+    /**
+     * Gets the shared table for a sample rate, creating it if no filter is using one yet,
+     * should not be called from the audio thread
+     *
+     * @param sampleRate is the sample rate of the table
+     *
+     * @return the table for the sample rate
+     *
+    */
+    static std::shared_ptr<const IIRCoeffTable> getTable(float sampleRate);
+    
+    /**
+     * Calculates the coefficients of one 2nd order section, normalised so the output coefficient is 1
+     *
+     * @param wp is the frequency warped cut off
+     * @param highPass true for high pass coefficients and false for low pass
+     * @param dampingCoeff is the butterworth coefficient of the section
+     * @param coeffs returns the 5 coefficients, b0, b1, b2, a1, a2
+     *
+    */
+    static void calcSectionCoeffs(double wp, bool highPass, double dampingCoeff, double* coeffs);
+    
+    /**
+     * Gets the interpolated coefficients of a filters sections from the table
+     *
+     * @param cutOffFreq is the cut off frequency in Hz
+     * @param highPass true for high pass coefficients and false for low pass
+     * @param minus24DbMode true for the two sections of the -24dB/oct filter and false for the one -12dB/oct section
+     * @param coeffs returns the 5 coefficients, b0, b1, b2, a1, a2, of each section
+     *
+     * @return true if the cut off was in the range of the table, if false coeffs are unchanged
+     *
+    */
+    bool lookupCoeffs(float cutOffFreq, bool highPass, bool minus24DbMode, double (*coeffs)[5]) const;
+    
+private:
+    
+    //Lowest cut off in the table and the number of table points in each octave
+    static constexpr double minFreq = 20.0;
+    static constexpr int pointsPerOctave = 48;
+    
+    //Number of cut off points in the table
+    int numPoints = 0;
+    
+    //Coefficients stored as [highPass][damping][point][coefficient]
+    std::vector<double> table;
+};
+
+//==============================================================================
 
 
 // =================================
@@ -21,11 +112,18 @@
 
 /*!
  @class myIIRFilter
- @abstract a IIR filter HP or LP that can processes mone samples
- @discussion multiple created with the StereoIIRFilters class
+ @abstract a IIR filter HP or LP that can processes mono or stereo samples
+ @discussion used by the StereoIIRFilters class. The butterworth responses are
+             made from normalised 2nd order sections in transposed direct form II, so each
+             section only keeps 2 state variables and the division by the output coefficient
+             is done when the coefficients are calculated rather than every sample.
+             Both channels share the coefficients and their states are stored side by side
+             so a stereo frame is filtered as one pair of doubles. Coefficients can be
+             calculated exactly, read from an IIRCoeffTable or, when a block is processed
+             with a moving cut off, calculated at the end of the block and interpolated
  
  @namespace none
- @updated 2020-04-24
+ @updated 2026-10-19
  */
 class MyIIRFilter
 {
@@ -38,6 +136,15 @@ public:
     ~MyIIRFilter();
     
     //==============================================================================
+    
+    //Ways the coefficients can be updated when the cut off changes
+    enum CoeffMode
+    {
+        exactCoeffs = 0,            //Calculated every time the cut off changes
+        tableCoeffs,                //Read from the coefficient table every time the cut off changes
+        blockInterpolatedCoeffs     //Calculated at the end of each block and interpolated across it
+    };
+    
     /**
      * Set the sample rate of the filter
      *
@@ -46,6 +153,22 @@ public:
     */
     void setSampleRate(float newSampleRate);
     
+    /**
+     * Set how the coefficients are updated when the cut off changes
+     *
+     * @param newCoeffMode is one of the values in CoeffMode
+     *
+    */
+    void setCoeffMode(int newCoeffMode);
+    
+    /**
+     * Set the number of channels processBlock filters, a mono filter only runs the left channel states
+     *
+     * @param newNumChannels is 1 for mono or 2 for stereo
+     *
+    */
+    void setNumChannels(int newNumChannels);
+    
     /**
      * Get's the next sample from the filter inputing the most recent sample
      *
@@ -56,12 +179,41 @@ public:
     */
     float processNextSample(float nextSample);
     
+    /**
+     * Filters a stereo frame, both channels are processed together with the same coefficients
+     *
+     * @param samples is an array of 2 samples, left and right, that are replaced with the filtered samples
+     *
+    */
+    void processNextFrame(float* samples);
+    
+    /**
+     * Filters a block of samples in place
+     *
+     * @param channels is an array of a channel pointer for each channel set by setNumChannels, each holding numSamples samples
+     * @param numSamples is the number of samples to filter
+     * @param cutoffRamp is an array of numSamples cut off frequencies in Hz to use for each sample,
+     *                   or nullptr to keep the current cut off for the whole block
+     *
+    */
+    void processBlock(float* const* channels, int numSamples, const float* cutoffRamp);
+    
     /**
      * Method to reset the filter previous input and output samples
      *
     */
     void resetFilter();
     
+    /**
+     * Checks if the filter has no tail left to output
+     *
+     * @param level is the level below which a state counts as silent
+     *
+     * @return true if every state of the sections in use is smaller than level
+     *
+    */
+    bool isSilent(double level) const;
+    
     /**
      * Set the filters cut off frequency
      *
@@ -117,12 +269,35 @@ public:
 private:
     
     /**
-     * Function to calculate the difference equations for the filter
+     * Function to calculate the difference equations for the filter, the -12dB/oct mode is one
+     * 2nd order section and the -24dB/oct mode is two 2nd order sections in series
      *
-     * @param typeChanged  marks if the filter type or order has recently changed requiring additional calculations
+    */
+    void calcDiffEqnCoeffs();
+    
+    /**
+     * Calculates the coefficients of every section for a cut off
+     *
+     * @param freq is the cut off frequency in Hz
+     * @param coeffs returns the coefficients of each section
+     *
+    */
+    void calcCoeffs(float freq, double (*coeffs)[5]);
+    
+    /**
+     * Filters a block of samples with the coefficients and states held in locals, the number of
+     * channels is a template parameter so the mono loops only do the work of one channel
+     *
+     * @param channels is an array of NumChannels channel pointers
+     * @param numSamples is the number of samples to filter
+     * @param coeffs are the coefficients of each section to start the block with
+     * @param coeffIncrements are added to the coefficients before each sample, nullptr if they are not interpolated
+     * @param cutoffRamp are cut offs to calculate the coefficients from for each sample, nullptr if the cut off is not moving
      *
     */
-    void calcDiffEqnCoeffs(bool typeChanged);
+    template <int NumChannels>
+    void processFrames(float* const* channels, int numSamples, double (*coeffs)[5], const double (*coeffIncrements)[5], const float* cutoffRamp);
+
     
     /**
      * Set the filters cut off frequency
@@ -159,33 +334,70 @@ private:
     
     bool type = false; //type is the variable that decides type of oscillator (false is low pass, true is highpass);
     bool minus24dbMode = false; //Order false is -12Db/oct mode, true is -24Db/oct mode
-    int order = 2;              //Order of the filter
+    int numSections = 1;        //Number of 2nd order sections used, 1 for -12dB/oct and 2 for -24dB/oct
+    
+    //Maximum number of 2nd order sections and channels
+    static constexpr int maxSections = 2;
+    static constexpr int numChannels = 2;
     
-    //Arrays for storing previous inputs and outputs used in the array
-    double prevInput[10] = {0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f};
-    double prevOutput[10] = {0.0f,0.0f,0.0f,0.0f,0.0f,0.0,0.0f,0.0f,0.0f,0.0f};
+    //Number of channels processBlock filters, set by setNumChannels
+    int activeChannels = numChannels;
     
-    //Delay line positon fot the prev input and output arrays
-    int delayLinePos = 0;
+    //The 2 state variables of each section for the transposed direct form II, stored as
+    //[section][state][channel] so the left and right values of a state sit next to each other
+    alignas(16) double sectionState[maxSections][2][numChannels] = {{{0.0, 0.0}, {0.0, 0.0}}, {{0.0, 0.0}, {0.0, 0.0}}};
     
     //Cut off frequency in Hz
     double cutOffFreq=100;
     
     //Sample time in s
-    double sampleTime = 1/48000;
+    double sampleTime = 1.0/48000;
     
     //Pi to be used in calculations
     double PI = 3.14159265358979;
     
-    //Frequency warped cut off
-    double wp = 1;
-    
-    //The coefficients for 2nd and 4th order filters
-    double secondOrderCoeff = 2 * sqrt(2);
-    double fourthOrderCoeff[2] = {2 * 0.7654, 2 * 1.8478};
+    //How the coefficients are updated and the shared coefficient table for the sample rate
+    int coeffMode = tableCoeffs;
+    std::shared_ptr<const IIRCoeffTable> coeffTable;
 
-    //Array for storing the difference equations parameters
-    double differenceEQNCoeffs[2][5];
+    //Array for storing the difference equations parameters of each section already divided by
+    //the output coefficient, stored as b0, b1, b2, a1, a2
+    double differenceEQNCoeffs[maxSections][5] = {{1.0, 0.0, 0.0, 0.0, 0.0}, {1.0, 0.0, 0.0, 0.0, 0.0}};
+    
+    /**
+     * Filters one frame through the sections
+     *
+     * @param channels is an array of NumChannels channel pointers
+     * @param i is the sample in the channels to filter, replaced with the filtered sample
+     * @param coeffs are the coefficients of each section
+     * @param state are the states of each section
+     * @param sections is the number of sections to use
+     *
+    */
+    template <int NumChannels>
+    static inline void filterFrame(float* const* channels, int i, const double (*coeffs)[5], double (*state)[2][numChannels], int sections)
+    {
+        alignas(16) double frame[NumChannels];
+        for(int ch = 0; ch < NumChannels; ++ch)
+            frame[ch] = channels[ch][i];
+        
+        for(int s = 0; s < sections; ++s)   //Pass the frame through each section in turn
+        {
+            //Each line works on both channels with the same coefficients so it maps onto one vector operation
+            alignas(16) double output[NumChannels];
+            for(int ch = 0; ch < NumChannels; ++ch)
+                output[ch] = coeffs[s][0] * frame[ch] + state[s][0][ch];
+            for(int ch = 0; ch < NumChannels; ++ch)
+                state[s][0][ch] = coeffs[s][1] * frame[ch] - coeffs[s][3] * output[ch] + state[s][1][ch];
+            for(int ch = 0; ch < NumChannels; ++ch)
+                state[s][1][ch] = coeffs[s][2] * frame[ch] - coeffs[s][4] * output[ch];
+            for(int ch = 0; ch < NumChannels; ++ch)
+                frame[ch] = output[ch];
+        }
+        
+        for(int ch = 0; ch < NumChannels; ++ch)
+            channels[ch][i] = (float) frame[ch];
+    }
 };
 
 //==============================================================================
@@ -197,10 +409,11 @@ private:
 /*!
  @class StereoIIRFilters
  @abstract processes a stereo sample with a high pass or low pass filter
- @discussion ustilises two instances of the myIIRFilter class
+ @discussion ustilises one myIIRFilter that filters both channels so the
+             coefficients are only calculated once per update
  
  @namespace none
- @updated 2020-04-24
+ @updated 2026-10-19
  */
 class StereoIIRFilters
 {
@@ -220,10 +433,7 @@ public:
     */
     void setSampleRate(float sampleRate)
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            filters[i].setSampleRate(sampleRate);
-        }
+        filter.setSampleRate(sampleRate);
     }
     
     /**
@@ -235,10 +445,7 @@ public:
     */
     void setFilterType(bool highPassMode)
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            filters[i].setFilterType(highPassMode);
-        }
+        filter.setFilterType(highPassMode);
     }
     
     /**
@@ -250,24 +457,18 @@ public:
     */
     void setFilterOrder(bool minus24DbMode)
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            filters[i].setFilterOrder(minus24DbMode);
-        }
+        filter.setFilterOrder(minus24DbMode);
     }
     
     /**
-     * Set the filters cut off frequency
+     * Set the filters cut off frequency, the coefficients are calculated once for both channels
      *
      * @param freq is the new cut off frequency in Hz
      *
     */
     void setFilterCutOffFreq(float freq)
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            filters[i].setFilterCutOffFreq(freq);
-        }
+        filter.setFilterCutOffFreq(freq);
     }
     
     /**
@@ -279,10 +480,43 @@ public:
     */
     void getNextSample(float* inputSamples)
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            inputSamples[i] = filters[i].processNextSample(inputSamples[i]);
-        }
+        filter.processNextFrame(inputSamples);
+    }
+    
+    /**
+     * Filters a block of samples in place
+     *
+     * @param channels is an array of a channel pointer for each channel set by setNumChannels, each holding numSamples samples
+     * @param numSamples is the number of samples to filter
+     * @param cutoffRamp is an array of numSamples cut off frequencies in Hz to use for each sample,
+     *                   or nullptr to keep the current cut off for the whole block
+     *
+    */
+    void process(float* const* channels, int numSamples, const float* cutoffRamp)
+    {
+        filter.processBlock(channels, numSamples, cutoffRamp);
+    }
+    
+    /**
+     * Set how the coefficients are updated when the cut off changes
+     *
+     * @param coeffMode is one of the values in MyIIRFilter::CoeffMode
+     *
+    */
+    void setCoeffMode(int coeffMode)
+    {
+        filter.setCoeffMode(coeffMode);
+    }
+    
+    /**
+     * Set the number of channels filtered, a mono voice only needs the left channel filtered
+     *
+     * @param numChannels is 1 for mono or 2 for stereo
+     *
+    */
+    void setNumChannels(int numChannels)
+    {
+        filter.setNumChannels(numChannels);
     }
     
     /**
@@ -291,15 +525,23 @@ public:
     */
     void resetFilter()
     {
-        for(int i = 0; i < 2; ++i)
-        {
-            filters[i].resetFilter();
-        }
+        filter.resetFilter();
+    }
+    
+    /**
+     * Checks if the filter has no tail left to output
+     *
+     * @param level is the level below which a state counts as silent
+     *
+    */
+    bool isSilent(double level) const
+    {
+        return filter.isSilent(level);
     }
     
 private:
     
-    //Creating an array of two IIR filters for each channel of stereo
-    MyIIRFilter filters[2];
+    //One filter that processes both channels of stereo with shared coefficients
+    MyIIRFilter filter;
     
 };
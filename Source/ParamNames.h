@@ -77,6 +77,20 @@ public:
         return lfoNames[lfoNum] + lfoParamNames[lfoParamNum];
     };
     
+    /**
+     * Get LFO Choice Parameter Names
+     *
+     * @param lfoNum the lfo number
+     * @param lfoChoiceParamNum the lfo choice parameter number
+     *
+     * @return returns a string containing concatanation of lfo name and choice parameter
+     *
+    */
+    std::string getLfoChoiceParamName(int lfoNum, int lfoChoiceParamNum)
+    {
+        return lfoNames[lfoNum] + lfoChoiceParamNames[lfoChoiceParamNum];
+    };
+    
     /**
      * Get Filter Parameter Names
      *
@@ -91,6 +105,19 @@ public:
         return filterNames[filterNum] + filterParamNames[filterParamNum];
     };
     
+    /**
+     * Get Drive Parameter Names
+     *
+     * @param driveParamNum the drive parameter number
+     *
+     * @return returns a string of drive parameter name
+     *
+    */
+    std::string getDriveParamName(int driveParamNum)
+    {
+        return driveParamNames[driveParamNum];
+    }
+    
     /**
      * Get Max Parameter Name
      *
@@ -107,7 +134,7 @@ public:
     //Oscillator types string array
     std::string typesOfOscs[6] = {"None", "Sine", "Saw", "Triangle", "Square", "Noise"};
     
-    int numMaxParams = 12; //Number of max parameters
+    int numMaxParams = 13; //Number of max parameters
     
 private:
     //Array containing envolope names
@@ -156,7 +183,8 @@ private:
     //Array containing lfo names
     std::string lfoNames[2]
     {
-      "lfo1"
+      "lfo1",
+      "lfo2"
     };
     
     //Array containing lfo parameter names
@@ -166,6 +194,13 @@ private:
       "Freq"
     };
     
+    //Array containing lfo choice parameter names
+    std::string lfoChoiceParamNames[2]
+    {
+      "Shape",
+      "Mode"
+    };
+    
     //Array containing filter names
     std::string filterNames[2]
     {
@@ -174,14 +209,22 @@ private:
     };
     
     //Array containing filter parameter names
-    std::string filterParamNames[2]
+    std::string filterParamNames[3]
     {
       "Mode",
-      "Freq"
+      "Freq",
+      "Res"
+    };
+    
+    //Array containing drive parameter names
+    std::string driveParamNames[2]
+    {
+      "driveMode",
+      "driveAmount"
     };
     
     //Array containing fmax parameter names
-    std::string maxParams[12]
+    std::string maxParams[13]
     {
         "osc1TuneMax",
         "osc1PanMax",
@@ -194,7 +237,8 @@ private:
         "lfo1DepthMax",
         "lfo1FreqMax",
         "lpFilterFreqMax",
-        "hpFilterFreqMax"
+        "hpFilterFreqMax",
+        "driveAmountMax"
     };
 
 };
@@ -46,8 +46,10 @@ public:
      * @param sustain sustain in percentage
      * @param relaseMS release in ms
      *
+     * @return true if any parameter changed
+     *
     */
-    void setParams(float attackMS, float decayMS, float sustain, float releaseMS)
+    bool setParams(float attackMS, float decayMS, float sustain, float releaseMS)
     {
         bool changed = false;
         if(compareVals(attackMS, currentADSRms[0])||compareVals(decayMS, currentADSRms[1])||compareVals(sustain, currentADSRms[2])||compareVals(releaseMS, currentADSRms[3]))   //If any parameter has changed
@@ -65,6 +67,7 @@ public:
             newVals = (newVals + 1) % 4; //Switch value of newVals
         }
         
+        return changed;
     }
     
     /**
@@ -172,13 +175,17 @@ public:
      *
      * @param newParams to set float parameters
      *
+     * @return true if any parameter changed
+     *
     */
-    void setParams(float* newParams)
+    bool setParams(float* newParams)
     {
         if(checkParams(params, newParams))  //Check parameters changed
         {
             newVals = (newVals + 1) % 4;    //Update value switch
+            return true;
         }
+        return false;
     };
     
     /**
@@ -187,18 +194,22 @@ public:
      * @param newChoice Params to set int parameters
      * @param newParams to set float parameters
      *
+     * @return true if any parameter changed
+     *
     */
-    void setParams(int* newChoiceParams, float* newParams)
+    bool setParams(int* newChoiceParams, float* newParams)
     {
+        bool changed = false;
         if(numChoiceParams !=0) //If there are any choice parameters
         {
             if(checkParams(choiceParams, newChoiceParams))  //Check if they have changed
             {
                 newVals = (newVals + 1) % 4;   //If changed then updated value switch
+                changed = true;
             }
         }
 
-        setParams(newParams);   //Do the same for the float parameters
+        return setParams(newParams) || changed;   //Do the same for the float parameters
     }
      
     /**
@@ -33,32 +33,41 @@ PostBoxSynthesiserProcessorEditor::PostBoxSynthesiserProcessorEditor (PostBoxSyn
     //Adding the envolope sliders and attaching them to appropriate parameters
     for(int i = 0; i < numEnvs; ++i)
     {
-        bool labelPos = i == 1 ? false : true;  //Placing the ENV Y sliders label above
+        bool labelPos = (i == 1 || i == 2) ? false : true;  //Placing the ENV Y and amp env sliders label above
         for(int j = 0; j < 4; ++j)
         {
             addSlider(uiSliders, rotaryDesign[i%4], envLabelNames[j], j == 2 ? "":"ms", labelPos);
             int envNum = i < 3 ? (i+1) % 3 : i;         //Fixing issue caused by how parameters were named so that the amp env is 0
             sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, processor.paramID.getEnvolopeParamName(envNum, j), *uiSliders[uiSliders.size()-1]));  //Attaching slider to appopriate parameter
         }
+        
+        if(i == 2)  //The curve of all the envolopes sits with the amp env sliders
+        {
+            addSlider(uiSliders, rotaryDesign[i%4], "Curve", "", labelPos);
+            sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, "envCurve", *uiSliders[uiSliders.size()-1]));
+        }
     }
     
-    //Adding singular lfo and it's sliders and attaching them to approriate parameters
-    for(int i =0; i < 2; i++)
+    //Adding the lfo sliders and attaching them to approriate parameters
+    for(int i = 0; i < numLfos; ++i)
     {
-        std::string suffix = i  == 1 ? "Hz" : "";
-        addSlider(uiSliders, rotaryDesign[3], lfoLabels[i], suffix);
-        sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, processor.paramID.getLfoParamName(0, i), *uiSliders[uiSliders.size()-1]));
+        for(int j = 0; j < 2; ++j)
+        {
+            std::string suffix = j  == 1 ? "Hz" : "";
+            addSlider(uiSliders, rotaryDesign[(i+3)%4], lfoLabels[j], suffix);
+            sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, processor.paramID.getLfoParamName(i, j), *uiSliders[uiSliders.size()-1]));
+        }
     }
     
-    //Adding the filter sliders and attaching them to appropriate parameters
+    //Adding the filter sliders and attaching them to appropriate parameters, the mode is a combobox
     for(int i = 0; i < numFilters; ++i)
     {
         auto* label = boldUiLabels.add(new Label("", filterNames[i]));
         addAndMakeVisible(label);
-        for(int j = 0; j < 2; ++j)
+        for(int j = 1; j < 3; ++j)
         {
             std::string suffix = j  == 1 ? "Hz" : "";
-            addSlider(uiSliders, rotaryDesign[i], filterLabels[j], suffix);
+            addSlider(uiSliders, rotaryDesign[i], filterLabels[j-1], suffix);
             sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, processor.paramID.getFilterParamName(i, j), *uiSliders[uiSliders.size()-1]));
         }
     }
@@ -68,7 +77,7 @@ PostBoxSynthesiserProcessorEditor::PostBoxSynthesiserProcessorEditor (PostBoxSyn
     sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, "masterGain", *uiSliders[uiSliders.size()-1]));
     
     //Intialising the title labels
-    for(int i = 0; i < 7; ++i)
+    for(int i = 0; i < 10; ++i)
     {
         auto* label = titleLabels.add(new Label("", nameLabels[i]));
         addAndMakeVisible(label);
@@ -84,12 +93,45 @@ PostBoxSynthesiserProcessorEditor::PostBoxSynthesiserProcessorEditor (PostBoxSyn
     //Adding comboboxes for the parameter envolopes and connecting it to appropriate parameters
     for(int i =0; i < numEnvs - 3; ++i)
     {
-        addComboBox(comboBoxes, comboBoxFillcustEnv, 13, "Parameter "+ std::to_string(i+1) +" Env:  ",std::to_string(i));
+        addComboBox(comboBoxes, comboBoxFillcustEnv, 14, "Parameter "+ std::to_string(i+1) +" Env:  ",std::to_string(i));
         comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, processor.paramID.getEnvolopeParamName(i+3, 4), *comboBoxes[comboBoxes.size()-1]));
     
         comboBoxes[comboBoxes.size()-1] -> addListener(this);   //Adding a listener to these combo boxes as they need to change slider attachments
     }
     
+    //Adding comboboxes for the lfo shapes and modes and connecting them to appropriate parameters
+    for(int i = 0; i < numLfos; ++i)
+    {
+        addComboBox(comboBoxes, comboBoxFillLfoShape, 6, "Shape:  ");
+        comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, processor.paramID.getLfoChoiceParamName(i, 0), *comboBoxes[comboBoxes.size()-1]));
+        
+        addComboBox(comboBoxes, comboBoxFillLfoMode, 2, "Mode:  ");
+        comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, processor.paramID.getLfoChoiceParamName(i, 1), *comboBoxes[comboBoxes.size()-1]));
+    }
+    
+    //Adding the morph mode combobox and connecting it to its parameter
+    addComboBox(comboBoxes, comboBoxFillMorphMode, 2, "Mode:  ");
+    comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, "morphMode", *comboBoxes[comboBoxes.size()-1]));
+    
+    //Adding the filter mode comboboxes and connecting them to appropriate parameters
+    for(int i = 0; i < numFilters; ++i)
+    {
+        addComboBox(comboBoxes, i == 0 ? comboBoxFillLpMode : comboBoxFillHpMode, i == 0 ? 7 : 5, "Mode:  ");
+        comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, processor.paramID.getFilterParamName(i, 0), *comboBoxes[comboBoxes.size()-1]));
+    }
+    
+    //Adding the drive mode combobox and connecting it to its parameter
+    addComboBox(comboBoxes, comboBoxFillDriveMode, 4, "Mode:  ");
+    comboAttachment.add(new AudioProcessorValueTreeState::ComboBoxAttachment(processor.parameters, processor.paramID.getDriveParamName(0), *comboBoxes[comboBoxes.size()-1]));
+    
+    //Adding the buttons that store the current settings as the morph snapshots, A is the start of the morph and B the end
+    for(int i = 0; i < 2; ++i)
+    {
+        auto* button = morphButtons.add(new TextButton(morphButtonNames[i]));
+        button -> onClick = [this, i] { processor.storeMorphSnapshot(i); };    //Button clicks come in on the message thread
+        addAndMakeVisible(button);
+    }
+    
     //Adding sliders for param envs max value sliders and attaching them to parameters
     for(int i =0; i < numEnvs - 3; ++i)
     {
@@ -98,8 +140,31 @@ PostBoxSynthesiserProcessorEditor::PostBoxSynthesiserProcessorEditor (PostBoxSyn
         storeSlider = uiSliders.size()-1;   //Storing position of last add slider
     }
     
-    //Setting size of the plugin so the resize() funciton is called
-    setSize (1080, 600);
+    //Adding the morph slider and attaching it to that parameter
+    addSlider(uiSliders, rotaryDesign[1], "Morph");
+    sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, "morph", *uiSliders[uiSliders.size()-1]));
+    
+    //Adding the drive amount slider and attaching it to that parameter
+    addSlider(uiSliders, rotaryDesign[2], "Amount");
+    sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, processor.paramID.getDriveParamName(1), *uiSliders[uiSliders.size()-1]));
+    
+    //Adding the polyphony slider below the master volume and attaching it to that parameter
+    addSlider(uiSliders, rotaryDesign[0], "Voices", "", false);
+    sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, "polyphony", *uiSliders[uiSliders.size()-1]));
+    
+    //Adding the oscillator surround depth sliders, next to the pan sliders, and attaching them to appropriate parameters
+    for(int i = 0; i < numOscs; ++i)
+    {
+        addSlider(uiSliders, rotaryDesign[i], "Depth");
+        sliderAttachment.add(new AudioProcessorValueTreeState::SliderAttachment(processor.parameters, "osc" + std::to_string(i+1) + "Depth", *uiSliders[uiSliders.size()-1]));
+    }
+    
+    //Setting size of the plugin so the resize() funciton is called, the main area is 600 high with the strip below it
+    setSize (1080, roundToInt(600 * (1.0f + stripHeight)));
+    
+   #if JUCE_DEBUG
+    startTimerHz(2);    //The denormal counts are only collected in debug builds
+   #endif
 }
 
 PostBoxSynthesiserProcessorEditor::~PostBoxSynthesiserProcessorEditor()
@@ -117,19 +182,19 @@ void PostBoxSynthesiserProcessorEditor::paint (Graphics& g)
     //Filling all with a background colour
     g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
     
-    //Defining the height and width
-    height = getLocalBounds().getHeight();
+    //Defining the height and width, the height is of the main area so the strip sits past 1
+    height = getLocalBounds().getHeight() / (1.0f + stripHeight);
     width = getLocalBounds().getWidth();
     
     //Drawing all containers
-    for(int i = 0; i < 7; ++i)
+    for(int i = 0; i < 10; ++i)
     {
         drawContainer(width * containerPositions[2 * i], containerPositions[2 * i + 1] * height, containerSizes[2 * i] * width, containerSizes[2 * i + 1] * height, containerColours[i], g);
     }
     
     //Drawing all slider containers
     int sliderContainerNum = 0;
-    for(int i = 0; i < 9; ++i)
+    for(int i = 0; i < 12; ++i)
     {
         for(int j = 0; j < sliderContainerSizes[3 * i]; ++j)
         {
@@ -162,9 +227,9 @@ void PostBoxSynthesiserProcessorEditor::resized()
     if (uiSliders.isEmpty())
         return;
     
-    //Getting height and width of the container
+    //Getting height and width of the container, the height is of the main area so the strip sits past 1
     width = getLocalBounds().getWidth();
-    height = getLocalBounds().getHeight();
+    height = getLocalBounds().getHeight() / (1.0f + stripHeight);
     
     //-----Setting Up Fonts----//
     //Setting Font Heights
@@ -178,7 +243,7 @@ void PostBoxSynthesiserProcessorEditor::resized()
     setLabelFonts(titleLabels, titleFont);
     
     //Setting positon of the container titles
-    for(int i = 0; i< 7; ++i)
+    for(int i = 0; i< 10; ++i)
     {
         titleLabels[i] -> setBounds(containerPositions[2*i] * width, containerPositions[2*i+1] * height, containerSizes[2*i] * width, 0.05 * height);
     }
@@ -190,9 +255,9 @@ void PostBoxSynthesiserProcessorEditor::resized()
     }
     
     //----Positioning up comboBoxes----//
-    for(int i = 0; i < 4; ++i)  //Oscillator comboboxes
+    for(int i = 0; i < 4; ++i)  //Oscillator comboboxes, sharing their row with the depth slider
     {
-        setComboPosition(comboBoxes, i, sliderContainerPositions[2 * i], sliderContainerPositions[2 * i + 1], sliderContainerSizes[1], sliderContainerSizes[2], 3, 3, 1, ((int)i/2) * 2, 1.95, 0.5);
+        setComboPosition(comboBoxes, i, sliderContainerPositions[2 * i], sliderContainerPositions[2 * i + 1], sliderContainerSizes[1], sliderContainerSizes[2], 3, 3, 1, ((int)i/2) * 2, 0.95, 0.5);
     }
     
     for(int i = 0; i < numEnvs - 3; ++i)    //Param env comboboxes
@@ -200,9 +265,33 @@ void PostBoxSynthesiserProcessorEditor::resized()
         setComboPosition(comboBoxes, i+4, sliderContainerPositions[2 * i + 24], sliderContainerPositions[2 * i + 25], sliderContainerSizes[25], sliderContainerSizes[26], 7, 1, 0, 0, 1.95, 0.7);
     }
     
+    for(int i = 0; i < numLfos; ++i)    //Lfo shape and mode comboboxes, stacked left of the lfo sliders
+    {
+        int lfoPosRef = i == 0 ? 14 : 34;   //Lfo 1 and lfo 2 slider container positions
+        for(int j = 0; j < 2; ++j)
+        {
+            setComboPosition(comboBoxes, 2 * i + j + 9, sliderContainerPositions[lfoPosRef], sliderContainerPositions[lfoPosRef + 1], sliderContainerSizes[13], sliderContainerSizes[14], 4, 2, 1, j, 0.95, 0.7);
+        }
+    }
+    
+    for(int i = 0; i < numFilters; ++i) //Filter mode comboboxes, on the same line as the filter name
+    {
+        setComboPosition(comboBoxes, i + 14, sliderContainerPositions[(i+9)*2], sliderContainerPositions[(i+9)*2 + 1] - 0.05, sliderContainerSizes[19], 0.05, 5, 1, 3, 0, 1.95, 0.7);
+    }
+    
+    //Drive mode combobox above the drive amount slider
+    setComboPosition(comboBoxes, 16, sliderContainerPositions[38], sliderContainerPositions[39], sliderContainerSizes[34], sliderContainerSizes[35], 3, 2, 1, 0, 1.6, 0.5);
+    
+    //Morph mode combobox with the store buttons to its left
+    setComboPosition(comboBoxes, 13, sliderContainerPositions[36], sliderContainerPositions[37], sliderContainerSizes[31], sliderContainerSizes[32], 5, 1, 3, 0, 0.95, 0.35);
+    for(int i = 0; i < 2; ++i)
+    {
+        setComponentPosition(*morphButtons[i], sliderContainerPositions[36], sliderContainerPositions[37], sliderContainerSizes[31], sliderContainerSizes[32], 5, 1, i, 0, 0.9, 0.4);
+    }
+    
     //----Positioning Sliders ---//
     int workingSliderNum = 0;
-    for(int i = 0; i < 22; ++i)
+    for(int i = 0; i < 29; ++i)
     {
         //Getting array positons for the slider from the silder arrange array
         int arrangePos = i * 5;
@@ -337,12 +426,17 @@ void PostBoxSynthesiserProcessorEditor::setLabelFonts(OwnedArray<Label> &labels,
 }
 
 void PostBoxSynthesiserProcessorEditor::setComboPosition(OwnedArray<ComboBox>& newComboBoxes, int comboNum, float containerPosX, float containerPosY, float containerWidth, float containerHeight, int numXDiv, int numYDiv, int xDivPos, int yDivPos, float xFillPercentage, float yFillPercentage)
+{
+    setComponentPosition(*newComboBoxes[comboNum], containerPosX, containerPosY, containerWidth, containerHeight, numXDiv, numYDiv, xDivPos, yDivPos, xFillPercentage, yFillPercentage);
+}
+
+void PostBoxSynthesiserProcessorEditor::setComponentPosition(Component& component, float containerPosX, float containerPosY, float containerWidth, float containerHeight, int numXDiv, int numYDiv, int xDivPos, int yDivPos, float xFillPercentage, float yFillPercentage)
 {
     //Getting x and y increments based on the set x and y divisions
     float xIncrement = containerWidth * width  / (float)numXDiv;
     float yIncrement = containerHeight * height / (float)numYDiv;
     
-    //Getting the size of the combobox
+    //Getting the size of the component
     float comboSizeX = xFillPercentage * xIncrement;
     float comboSizeY = yFillPercentage * yIncrement;
     
@@ -350,12 +444,12 @@ void PostBoxSynthesiserProcessorEditor::setComboPosition(OwnedArray<ComboBox>& n
     int numCoveredXDivs = ceil(xFillPercentage);
     int numCoveredYDivs = ceil(yFillPercentage);
     
-    //Getting position of combobox such that it is centred in the divisions it covers
+    //Getting position of component such that it is centred in the divisions it covers
     float xPos = containerPosX * width + xIncrement * (xDivPos + (numCoveredXDivs/2.0f)) - 0.5 * comboSizeX;
     float yPos = containerPosY  * height+ yIncrement * (yDivPos + (numCoveredYDivs/2.0f)) - 0.5 * comboSizeY;
     
-    //Placing the comboBox
-    newComboBoxes[comboNum] -> setBounds(xPos, yPos, comboSizeX, comboSizeY);
+    //Placing the component
+    component.setBounds(xPos, yPos, comboSizeX, comboSizeY);
 }
 
 
@@ -366,6 +460,21 @@ void PostBoxSynthesiserProcessorEditor::setFontHeight(Font& thisFont, float font
 }
 
 
+void PostBoxSynthesiserProcessorEditor::timerCallback()
+{
+    int counts[PostBoxSynth::numDenormalStages];
+    int total = 0;
+    for(int stage = 0; stage < PostBoxSynth::numDenormalStages; ++stage)
+    {
+        counts[stage] = processor.takeDenormalCount(stage);
+        total += counts[stage];
+    }
+    
+    if(total > 0)   //Only report when there were denormals
+        DBG("Denormals, oscs: " << counts[PostBoxSynth::oscDenormals] << " envolopes: " << counts[PostBoxSynth::envDenormals]
+            << " lfo: " << counts[PostBoxSynth::lfoDenormals] << " filters: " << counts[PostBoxSynth::filterDenormals]);
+}
+
 void PostBoxSynthesiserProcessorEditor::comboBoxChanged (ComboBox *comboBoxThatHasChanged)
 {
     int currentVal = comboBoxThatHasChanged -> getSelectedId();     //Getting selected value in combobox
@@ -108,7 +108,8 @@ private:
  @updated 2020-04-24
  */
 class PostBoxSynthesiserProcessorEditor  : public AudioProcessorEditor,   //Inheriting from juce editor, to make it an editor
-                                         public ComboBox::Listener      //Inheriting from combobox listener to make changes based on a combo box selection
+                                         public ComboBox::Listener,     //Inheriting from combobox listener to make changes based on a combo box selection
+                                         private Timer                  //Inheriting from timer to report the denormal counts in debug builds
 {
 public:
     //==============================================================================
@@ -169,6 +170,12 @@ private:
     */
     void comboBoxChanged (ComboBox *comboBoxThatHasChanged) override;
     
+    /**
+     * Reports the denormal counts the processor collected since the last call, on the message thread
+     *
+    */
+    void timerCallback() override;
+    
     /**
      * Method to apply fonts to an array of labels
      *
@@ -230,6 +237,24 @@ private:
     */
     void setComboPosition(OwnedArray<ComboBox>& newComboBoxes, int comboNum, float containerPosX, float containerPosY, float containerWidth, float containerHeight, int numXDiv, int numYDiv, int xDivPos, int yDivPos, float xFillPercentage, float yFillPercentage);
     
+    /**
+     * Funciton for placing any component into a container, used by setComboPosition and for the buttons
+     *
+     * @param component is the component to place
+     * @param containerPosX is the container X position (as percentage of width)
+     * @param containerPosY is the container Y position (as percentage of height)
+     * @param containerWidth is the container X size (as percentage of width)
+     * @param containerHeight is the container Y size (as percentage of height)
+     * @param numXDiv is the number of divisions to split container into horizontally
+     * @param numYDiv is the number of divisions to splt the container into vertically
+     * @param xDivPos is which x div the component is placed in
+     * @param yDivPos  is which y div the component is placed in
+     * @param xFillPercentage is how much component fills the horizontal division if >1 fills adjacent divisions as well
+     * @param yFillPercentage is how mich component fills the vertical division
+     *
+    */
+    void setComponentPosition(Component& component, float containerPosX, float containerPosY, float containerWidth, float containerHeight, int numXDiv, int numYDiv, int xDivPos, int yDivPos, float xFillPercentage, float yFillPercentage);
+    
     
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -247,6 +272,7 @@ private:
     int numOscs = 4;
     int numEnvs = 8;
     int numFilters = 2;
+    int numLfos = 2;
     
     //Array to store slider designs in
     OwnedArray<NewRotaryDesign> rotaryDesign;
@@ -254,34 +280,43 @@ private:
     //Amount to decrease heights by to fit parameter envolopes in
     float hDecrease = 0.87f;
     
+    //Height of the strip of controls below the main area as a percentage of the main area height
+    float stripHeight = 0.16f;
+    
     //An array that has all the container sizes as percentage of window height and width
-    float containerSizes[16] = {0.6, 0.55f * hDecrease, //Osc Container
+    float containerSizes[22] = {0.6, 0.55f * hDecrease, //Osc Container
                                 0.6, 0.2f * hDecrease,  //Env X Container
                                 0.15, 0.55f * hDecrease,   //Env Y Container
-                                0.15, 0.2f * hDecrease,     //Lfo Container
+                                0.3, stripHeight,     //Lfo 1 Container
                                 0.25, 0.35f * hDecrease,    //Amp Env Container
                                 0.25, 0.4f * hDecrease,     //Filter Container
                                 0.1, 0.3475,           //Master Gain Container
+                                0.3, stripHeight,     //Lfo 2 Container
+                                0.4, stripHeight,     //Morph Container
+                                0.15, 0.2f * hDecrease,     //Drive Container
                                 0.9, 0.3475            //Param Env Container
                                 };
     
     //An array that has all the slider container sizes as percentage of window height and width
-    float sliderContainerSizes[30] =   {4, 0.288, 0.235f * hDecrease, //Osc Slider Container
+    float sliderContainerSizes[39] =   {4, 0.288, 0.235f * hDecrease, //Osc Slider Container
                                         1, 0.15, 0.3f * hDecrease, //XY graph box
         
                                         1, 0.584, 0.2f * hDecrease, //EnvX SLider Container
                                         1, 0.15, 0.5f * hDecrease, //EnvY SliderContainer
         
-                                        1, 0.14, 0.14f * hDecrease, //Lfo slider container
+                                        1, 0.284, 0.105, //Lfo 1 slider container
                                         1, 0.225, 0.28f * hDecrease,    //Amp env elider container
                                         2, 0.2375, 0.1f * hDecrease, //LP HP Slider Container
                                         1, 0.1f, 0.3475,    //Master Gain Slider Container
                                         5, 0.8f, 0.0655,    //Param Env Slider Container
+                                        1, 0.284, 0.105, //Lfo 2 slider container
+                                        1, 0.384, 0.105, //Morph slider container
+                                        1, 0.14, 0.14f * hDecrease, //Drive slider container
                                         1, 0.8f, 0.0655    //Max Param Env Slider Container
                                         };
     
     //An array that has all the slider container positions as percentage of window height and width
-    float sliderContainerPositions[34] =   {0.008, 0.06f * hDecrease, //Osc 1 Slider Container
+    float sliderContainerPositions[40] =   {0.008, 0.06f * hDecrease, //Osc 1 Slider Container
                                             0.304, 0.06f * hDecrease, //Osc 2 Slider Container
                                             0.008, 0.305f * hDecrease, //Osc 3 Slider Container
                                             0.304, 0.305f * hDecrease, //Osc 4 Slider Container
@@ -290,7 +325,7 @@ private:
                                             0.008, 0.55f * hDecrease, //EnvX SLider Container
                                             0.6, 0.05f * hDecrease, //EnvY SliderContainer
         
-                                            0.605, 0.6f * hDecrease, //Lfo slider Container
+                                            0.008, 1.045f, //Lfo 1 slider Container
                                             0.7625, 0.05f * hDecrease, //Amp Env Slider Container
                                             0.75625, 0.45f * hDecrease, //LP slider Container
                                             0.75625, 0.62f * hDecrease, //HP slider Container
@@ -302,29 +337,36 @@ private:
                                             0.1f, 0.7935f, //Param 3 slider Env Container
                                             0.1f, 0.863f,  //Param 4 slider Env Container
                                             0.1f, 0.9325f, //Param 5 slider Env Container
+        
+                                            0.308, 1.045f, //Lfo 2 slider Container
+                                            0.608, 1.045f, //Morph slider Container
+                                            0.605, 0.6f * hDecrease, //Drive slider Container
                                             };
     
     //An array that has all the container sizes as percentage of window height and width
-    float containerPositions[16] = {0, 0.0f * hDecrease, //Osc Container
+    float containerPositions[22] = {0, 0.0f * hDecrease, //Osc Container
                                     0, 0.55f * hDecrease,  //Env X Container
                                     0.6, 0.0f * hDecrease,   //Env Y Container
-                                    0.6, 0.55f * hDecrease,     //Lfo Container
+                                    0, 1.0f,     //Lfo 1 Container
                                     0.75, 0.0f * hDecrease,    //Amp Env Container
                                     0.75, 0.35f * hDecrease,     //Filter Container
                                     0.9, 0.6525f, //Master Gain Container
+                                    0.3, 1.0f,     //Lfo 2 Container
+                                    0.6, 1.0f,     //Morph Container
+                                    0.6, 0.55f * hDecrease,    //Drive Container
                                     0, 0.6525f,          //Param env Container
                                     };
     
     float sliderSizes[2] = {0.0929, 0.072f * hDecrease}; //Slider Sizes
     
      //An array that has all the slider arrange information which references the position array, size array layout array, offset array and label positon
-    int sliderArrangeInfo[110] ={0, 0, 0, 0, 0,//Osc 1   position ref, size ref, layout ref, offset ref, label pos
+    int sliderArrangeInfo[145] ={0, 0, 0, 0, 0,//Osc 1   position ref, size ref, layout ref, offset ref, label pos
                                 1, 0, 0, 1, 0,//Osc 2
                                 2, 0, 0, 2, 0,//Osc 3
                                 3, 0, 0, 3, 0,//Osc 4
                                 5, 2, 1, 4, 0,//Env X
                                 6, 3, 2, 5, 1,//Env Y
-                                8, 5, 4, 8, 0,//Amp Env
+                                8, 5, 4, 8, 1,//Amp Env
         
                                 12, 8, 6, 10, 0, //Param 1 slider Env
                                 13, 8, 6, 10, 0, //Param 2 slider Env
@@ -332,52 +374,69 @@ private:
                                 15, 8, 6, 10, 0,//Param 4 slider Env
                                 16, 8, 6, 10, 0,//Param 4 slider Env
         
-                                7, 4, 3, 6, 0,//Lfo row 1
-                                7, 4, 3, 7, 0,//Lfo row 2
+                                7, 4, 3, 6, 0,//Lfo 1
+                                17, 9, 3, 7, 0,//Lfo 2
 
                                 9, 6, 5, 9, 0,//Low Pass Filter
                                 10,6, 5, 9, 0,//High Pass Filter
                                 
                                 11, 7, 8, 12, 1, //Master Gain Slider
         
-                                12, 9, 7, 11, 0, //Param 1 max slider
-                                13, 9, 7, 11, 0, //Param 2 max slider Env
-                                14, 9, 7, 11, 0, //Param 3 max slider Env
-                                15, 9, 7, 11, 0, //Param 4 max slider Env
-                                16, 9, 7, 11, 0 //Param 4 max slider Env
+                                12, 12, 7, 11, 0, //Param 1 max slider
+                                13, 12, 7, 11, 0, //Param 2 max slider Env
+                                14, 12, 7, 11, 0, //Param 3 max slider Env
+                                15, 12, 7, 11, 0, //Param 4 max slider Env
+                                16, 12, 7, 11, 0, //Param 4 max slider Env
+        
+                                18, 10, 9, 13, 0, //Morph slider
+                                19, 11, 10, 14, 0, //Drive amount slider
+                                11, 7, 8, 15, 1, //Polyphony slider
+        
+                                0, 0, 11, 16, 0, //Osc 1 depth slider
+                                1, 0, 11, 16, 0, //Osc 2 depth slider
+                                2, 0, 11, 17, 0, //Osc 3 depth slider
+                                3, 0, 11, 17, 0 //Osc 4 depth slider
                                 };
     
     //Slider layout array that defines number of sliders in the slider container, the x and y divisions and number of sliders per horizontal
     //Num sliders, x div, y div, num sliders per horizintal
-    float sliderLayout[36] =   {4, 3, 3, 2,     //Osc Sliders
+    float sliderLayout[48] =   {4, 3, 3, 2,     //Osc Sliders
                                 4, 4, 3, 4,     //EnvX Sliders
                                 4, 3, 4, 1,     //EnvY Sliders
-                                1, 2, 2, 1,     //LFO SLiders
-                                4, 2, 2, 2,     //Amp Env Sliders
+                                2, 4, 1, 2,     //LFO SLiders
+                                5, 3, 2, 3,     //Amp Env Sliders
                                 2, 2, 1, 2,     //Filter sliders
                                 4, 7, 1, 4,     //Param Env Sliders
                                 1, 7, 1, 1,     //Param Env Max Val SLiders
-                                1, 1, 1, 1      //Master Gain Slider
+                                1, 1, 2, 1,     //Master Gain Slider
+                                1, 5, 1, 1,     //Morph Slider
+                                1, 3, 2, 1,     //Drive Slider
+                                1, 3, 3, 1      //Osc Depth Sliders
                                 };
     
     //Slider Offset array that defines slider x division offset and y divsion offset
-    float sliderOffsets[26] =  {0, 1,   //Osc 1 Sliders
+    float sliderOffsets[36] =  {0, 1,   //Osc 1 Sliders
                                 1, 1,   //Osc 2 Sliders
                                 0, 0,   //Osc 3 Sliders
                                 1, 0,   //Osc 4 Sliders
                                 0, 1,   //Env X Sliders
                                 1, 0,   //Osc Y Sliders
-                                0, 0,   //Lfo first Slider
-                                1, 1,   //Lfo second Slider
+                                2, 0,   //Lfo 1 Sliders
+                                2, 0,   //Lfo 2 Sliders
                                 0, 0,   //Amp Env Sliders
                                 0, 0,   //Filter Siders
                                 3, 0,   //Param Env Sliders
                                 2, 0,   //Param Max Val Sliders
-                                0, 0    //Mater Gain Slider
+                                0, 0,   //Mater Gain Slider
+                                4, 0,   //Morph Slider
+                                1, 1,   //Drive Slider
+                                0, 1,   //Polyphony Slider
+                                2, 0,   //Osc 1 and 2 Depth Sliders
+                                2, 2    //Osc 3 and 4 Depth Sliders
                                 };
     //Arrays defining the colours of the containers
-    Colour containerColours[8] = {Colours::darkgrey, Colours::slategrey, Colours::slategrey, Colours::darkgrey, Colours::darkgrey, Colours::dimgrey, Colours::darkgrey, Colours::grey};
-    Colour sliderContainerColours[9] = {Colours::dimgrey, Colours::lightgrey, Colours::slategrey, Colours::slategrey,  Colours::dimgrey, Colours::dimgrey, Colours::darkgrey, Colours::black, Colours::darkgrey};
+    Colour containerColours[11] = {Colours::darkgrey, Colours::slategrey, Colours::slategrey, Colours::darkgrey, Colours::darkgrey, Colours::dimgrey, Colours::darkgrey, Colours::darkgrey, Colours::slategrey, Colours::dimgrey, Colours::grey};
+    Colour sliderContainerColours[12] = {Colours::dimgrey, Colours::lightgrey, Colours::slategrey, Colours::slategrey,  Colours::dimgrey, Colours::dimgrey, Colours::darkgrey, Colours::black, Colours::darkgrey, Colours::dimgrey, Colours::darkgrey, Colours::darkgrey};
     
     //Array defining the posible slider colours
     Colour sliderColours[4] = {Colours::red, Colours::blue, Colours::yellow, Colours::green};
@@ -385,11 +444,12 @@ private:
     //Arrays defining label Names
     std::string  oscLabelNames[4] = {"Tune (ST)", "Pan", "Min Amp", "Max Amp"};
     std::string  envLabelNames[4] = {"Attack", "Decay", "Sustain", "Release"};
-    std::string  filterLabels[2] = {"Filter Mode", "Cut-Off Freq"};
+    std::string  filterLabels[2] = {"Cut-Off Freq", "Resonance"};
     std::string  lfoLabels[2] = {"Amp", "Freq"};
     
     //Arrays defining title Names
-    std::string  nameLabels[7] = {"Sources", "X Axis Envolope", "Y Axis Envolope", "Lfo", "Amplitude Envolope", "Filters","Master Volume"};
+    std::string  nameLabels[10] = {"Sources", "X Axis Envolope", "Y Axis Envolope", "Lfo 1", "Amplitude Envolope", "Filters","Master Volume", "Lfo 2", "Preset Morph", "Drive"};
+    std::string  morphButtonNames[2] = {"Store A", "Store B"};
     std::string filterNames[2] = {"Low Pass Filter", "High Pass Filter"};
     
     //The fonts used
@@ -400,12 +460,21 @@ private:
     //Defing combo boxes and the arrays of strings to fill them with
     OwnedArray<ComboBox> comboBoxes;
     std::string comboBoxFill[6] = {"None", "Sine", "Square", "Triangle", "Saw", "Noise"};
-    std::string comboBoxFillcustEnv[13] = {"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"};
+    std::string comboBoxFillLfoShape[6] = {"Sine", "Triangle", "Saw", "Square", "Sample & Hold", "Smooth Random"};
+    std::string comboBoxFillLfoMode[2] = {"Per Voice", "Global"};
+    std::string comboBoxFillMorphMode[2] = {"Off", "On"};
+    std::string comboBoxFillLpMode[7] = {"None", "-12dB/oct", "-24dB/oct", "SVF Low Pass", "SVF Band Pass", "SVF Notch", "Formant"};
+    std::string comboBoxFillHpMode[5] = {"None", "-12dB/oct", "SVF High Pass", "SVF Band Pass", "SVF Notch"};
+    std::string comboBoxFillDriveMode[4] = {"Off", "Tanh", "Hard Clip", "Asymmetric"};
+    std::string comboBoxFillcustEnv[14] = {"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"};
     
     //Array of slider and comboBox attachments to like sliders and comboboxes to processor parameters
     OwnedArray<AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
     OwnedArray<AudioProcessorValueTreeState::ComboBoxAttachment> comboAttachment;
     
+    //Buttons that store the current settings as the start and end of the morph
+    OwnedArray<TextButton> morphButtons;
+    
     //The width and height of the ui box
     float width;
     float height;
@@ -66,6 +66,13 @@ parameters(*this, nullptr, "Parameters", {
     //Lfo Paramters
     std::make_unique<AudioParameterFloat>("lfo1Depth", "LFO Depth", 0.0f, 1.0f, 0.0f),
     std::make_unique<AudioParameterFloat>("lfo1Freq", "LFO Frequency (Hz)", 0.001f, 20.0f, 10.0f),
+    std::make_unique<AudioParameterChoice>("lfo1Shape", "LFO Shape", StringArray({"Sine","Triangle","Saw","Square","Sample & Hold","Smooth Random"}), 0),
+    std::make_unique<AudioParameterChoice>("lfo1Mode", "LFO Mode", StringArray({"Per Voice","Global"}), 0),
+    
+    std::make_unique<AudioParameterFloat>("lfo2Depth", "LFO 2 Depth", 0.0f, 1.0f, 0.0f),
+    std::make_unique<AudioParameterFloat>("lfo2Freq", "LFO 2 Frequency (Hz)", 0.001f, 20.0f, 10.0f),
+    std::make_unique<AudioParameterChoice>("lfo2Shape", "LFO 2 Shape", StringArray({"Sine","Triangle","Saw","Square","Sample & Hold","Smooth Random"}), 0),
+    std::make_unique<AudioParameterChoice>("lfo2Mode", "LFO 2 Mode", StringArray({"Per Voice","Global"}), 1),
     
     //Envolope params for the whole note
     std::make_unique<AudioParameterFloat>("attack", "Master Attack (ms)", 0.001f, 2000.0f, 1000.0f),
@@ -73,15 +80,24 @@ parameters(*this, nullptr, "Parameters", {
     std::make_unique<AudioParameterFloat>("sustain", "Master Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("release", "Master Release (ms)", 0.001f, 2000.0f, 1000.0f),
     
+    //Envolope curve for all envolopes, 0 is linear and 1 is analog style exponential
+    std::make_unique<AudioParameterFloat>("envCurve", "Envolope Curve", 0.0f, 1.0f, 0.0f),
+    
     //Filter params
     
     //LP Filter
-    std::make_unique<AudioParameterChoice>("lpFilterMode", "Low Pass Filter Mode", StringArray({"None","-12dB/oct","-24dB/oct"}), 0),
+    std::make_unique<AudioParameterChoice>("lpFilterMode", "Low Pass Filter Mode", StringArray({"None","-12dB/oct","-24dB/oct","SVF Low Pass","SVF Band Pass","SVF Notch","Formant"}), 0),
     std::make_unique<AudioParameterFloat>("lpFilterFreq", "Low Pass Filter Frequency (Hz)", 30.0f, 20000.0f, 1000.0f),
+    std::make_unique<AudioParameterFloat>("lpFilterRes", "Low Pass Filter Resonance", 0.0f, 1.0f, 0.0f),
     
     //HP Filter
-    std::make_unique<AudioParameterChoice>("hpFilterMode", "High Pass Filter Mode", StringArray({"None","-12dB/oct"}), 0),
+    std::make_unique<AudioParameterChoice>("hpFilterMode", "High Pass Filter Mode", StringArray({"None","-12dB/oct","SVF High Pass","SVF Band Pass","SVF Notch"}), 0),
     std::make_unique<AudioParameterFloat>("hpFilterFreq", "High Pass Filter Frequency (Hz)", 30.0f, 20000.0f, 1000.0f),
+    std::make_unique<AudioParameterFloat>("hpFilterRes", "High Pass Filter Resonance", 0.0f, 1.0f, 0.0f),
+    
+    //Drive bettween the LFO and the filters
+    std::make_unique<AudioParameterChoice>("driveMode", "Drive Mode", StringArray({"Off","Tanh","Hard Clip","Asymmetric"}), 0),
+    std::make_unique<AudioParameterFloat>("driveAmount", "Drive Amount", 0.0f, 1.0f, 0.5f),
     
     //----Additional Envolope params----//
     
@@ -98,57 +114,73 @@ parameters(*this, nullptr, "Parameters", {
     std::make_unique<AudioParameterFloat>("lfo1FreqMax", "LFO Frequency Max(Hz)", 0.001f, 20.0f, 10.0f),
     std::make_unique<AudioParameterFloat>("lpFilterFreqMax", "Low Pass Filter Frequency Max(Hz)", 30.0f, 20000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("hpFilterFreqMax", "High Pass Filter Frequency Max (Hz)", 30.0f, 20000.0f, 1000.0f),
+    std::make_unique<AudioParameterFloat>("driveAmountMax", "Drive Amount Max", 0.0f, 1.0f, 0.5f),
     
     //Additional env 1
-    std::make_unique<AudioParameterChoice>("paramEnv1Choice","Param Env 1 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"}), 0),
+    std::make_unique<AudioParameterChoice>("paramEnv1Choice","Param Env 1 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"}), 0),
     std::make_unique<AudioParameterFloat>("paramEnv1attack", "Param Env Attack (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv1decay", "Param Env Decay (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv1sustain", "Param Env Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("paramEnv1release", "Param Env Release (ms)", 0.001f, 5000.0f, 1000.0f),
     
     //Additional env 2
-    std::make_unique<AudioParameterChoice>("paramEnv2Choice","Param Env 2 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"}), 0),
+    std::make_unique<AudioParameterChoice>("paramEnv2Choice","Param Env 2 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"}), 0),
     std::make_unique<AudioParameterFloat>("paramEnv2attack", "Param Env 2 Attack (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv2decay", "Param Env 2 Decay (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv2sustain", "Param Env 2 Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("paramEnv2release", "Param Env 2 Release (ms)", 0.001f, 5000.0f, 1000.0f),
     
     //Additional env 3
-    std::make_unique<AudioParameterChoice>("paramEnv3Choice","Param Env 3 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"}), 0),
+    std::make_unique<AudioParameterChoice>("paramEnv3Choice","Param Env 3 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"}), 0),
     std::make_unique<AudioParameterFloat>("paramEnv3attack", "Param Env 3 Attack (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv3decay", "Param Env 3 Decay (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv3sustain", "Param Env 3 Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("paramEnv3release", "Param Env 3 Release (ms)", 0.001f, 5000.0f, 1000.0f),
     
     //Additional env 4
-    std::make_unique<AudioParameterChoice>("paramEnv4Choice","Param Env 4 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"}), 0),
+    std::make_unique<AudioParameterChoice>("paramEnv4Choice","Param Env 4 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"}), 0),
     std::make_unique<AudioParameterFloat>("paramEnv4attack", "Param Env 4 Attack (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv4decay", "Param Env 4 Decay (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv4sustain", "Param Env 4 Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("paramEnv4release", "Param Env 4 Release (ms)", 0.001f, 5000.0f, 1000.0f),
     
     //Additional env 5
-    std::make_unique<AudioParameterChoice>("paramEnv5Choice","Param Env 5 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency"}), 0),
+    std::make_unique<AudioParameterChoice>("paramEnv5Choice","Param Env 5 choice", StringArray({"None","Osc 1 Tune", "Osc 1 Pan", "Osc 2 Tune", "Osc 2 Pan", "Osc 3 Tune", "Osc 3 Pan", "Osc 4 Tune", "Osc 4 Pan", "Lfo Depth", "Lfo Frequency","Low pass Filter Frequency", "High pass Filter Frequency", "Drive Amount"}), 0),
     std::make_unique<AudioParameterFloat>("paramEnv5attack", "Param Env 5 Attack (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv5decay", "Param Env 5 Decay (ms)", 0.001f, 5000.0f, 1000.0f),
     std::make_unique<AudioParameterFloat>("paramEnv5sustain", "Param Env 5 Sustain (%)", 0.0f, 100.0f, 50.0f),
     std::make_unique<AudioParameterFloat>("paramEnv5release", "Param Env 5 Release (ms)", 0.001f, 5000.0f, 1000.0f),
     
     //Master Gain
-    std::make_unique<AudioParameterFloat>("masterGain", "Master Gain", 0, 2.0f, 1.0f)
+    std::make_unique<AudioParameterFloat>("masterGain", "Master Gain", 0, 2.0f, 1.0f),
+    
+    //Number of voices that can play at once
+    std::make_unique<AudioParameterInt>("polyphony", "Polyphony", 1, PostBoxSynthesiser::maxVoices, 8),
+    
+    //Preset morphing between the two stored snapshots
+    std::make_unique<AudioParameterChoice>("morphMode", "Morph Mode", StringArray({"Off","On"}), 0),
+    std::make_unique<AudioParameterFloat>("morph", "Morph", 0.0f, 1.0f, 0.0f),
+    
+    //How far in front or behind the listener each source is on a surround output
+    std::make_unique<AudioParameterFloat>("osc1Depth", "Osc 1 Depth", -1, 1, 1),
+    std::make_unique<AudioParameterFloat>("osc2Depth", "Osc 2 Depth", -1, 1, 1),
+    std::make_unique<AudioParameterFloat>("osc3Depth", "Osc 3 Depth", -1, 1, 1),
+    std::make_unique<AudioParameterFloat>("osc4Depth", "Osc 4 Depth", -1, 1, 1)
     
 
 })
 {
     //Setting up the synth
     mySynth.addSound(new PostBoxSynthSound());
-    for(int i = 0; i < numVoices; ++i)
+    voiceArena.reserve(PostBoxSynthesiser::maxVoices * VoiceArena::alignedSize(sizeof(PostBoxSynth)));  //One block for the whole pool
+    for(int i = 0; i < PostBoxSynthesiser::maxVoices; ++i)  //Creating the whole pool, the polyphony sets how many play
     {
-        mySynth.addVoice(new PostBoxSynth(numOscs, numEnvs, numFilters));
+        mySynth.addVoice(new (voiceArena) PostBoxSynth());
     }
+    jassert(paramID.numMaxParams == PostBoxSynth::numEnvolopedParams);  //Parameter envolope choices must match the voices destinations
     
-    //Adding a listener for all the parameters
-    parameters.state.addListener(this);
+    //Looking up all the parameters the voices use so they can be read each block
+    cacheParamPointers();
     
     //Adding the envolope parameters storing objects
     for(int i = 0; i < numEnvs; ++i)
@@ -162,16 +194,17 @@ parameters(*this, nullptr, "Parameters", {
         oscillatorParams.add(new SimpleParams(1, 4));
     }
 
-    //Adding LFO parameter storing objects
+    //Adding LFO parameter storing objects and global LFOs
     for(int i = 0; i < numLFOs; ++i)
     {
-        lfoParams.add(new SimpleParams(0, 2));
+        lfoParams.add(new SimpleParams(2, 2));
+        globalLFOs.add(new SynthLFO());
     }
     
     //Adding filter parameter storing objects
     for(int i = 0; i < numFilters; ++i)
     {
-        filterParams.add(new SimpleParams(1, 1));
+        filterParams.add(new SimpleParams(1, 2));
     }
 
     //Adding Param Envolope storing objects
@@ -180,9 +213,22 @@ parameters(*this, nullptr, "Parameters", {
         paramEnvChoice.add(new SimpleParams(1, 1));
     }
     
+    //Pointing the synth at the parameters it passes to the voices
+    mySynth.setParamSources(&envolopeParams, &oscillatorParams, &lfoParams, &filterParams, &driveParams, &paramEnvChoice);
+    
     //Adding parameter for the master gain
     gainParam = parameters.getRawParameterValue("masterGain");
     
+    //Adding parameter for the polyphony
+    polyphonyParam = parameters.getRawParameterValue("polyphony");
+    
+    //Adding parameter for the envolope curve
+    envCurveParam = parameters.getRawParameterValue("envCurve");
+    
+    //Adding parameters for morphing
+    morphModeParam = parameters.getRawParameterValue("morphMode");
+    morphParam = parameters.getRawParameterValue("morph");
+    
 }
 
 PostBoxSynthesiserProcessor::~PostBoxSynthesiserProcessor()
@@ -256,13 +302,25 @@ void PostBoxSynthesiserProcessor::prepareToPlay (double sampleRate, int samplesP
 {
     mySynth.setCurrentPlaybackSampleRate(sampleRate); //Setting synth sample rate
     
-    for(int i=0; i < numVoices; ++i)    //Initalising the synth voices
+    //Setting up the global LFOs and the buffer they are rendered to
+    for(int i = 0; i < numLFOs; ++i)
     {
-        PostBoxSynth* v = dynamic_cast<PostBoxSynth*>(mySynth.getVoice(i));   //Getting the voice
-        v -> setSampleRate(sampleRate);  //Initilising voice sample rate
-        setParamTargets();      //Getting update parameter targets
-        v -> setParams(envolopeParams, oscillatorParams, lfoParams, filterParams, paramEnvChoice); //Updating voice parameters
+        globalLFOs[i] -> setSampleRate(sampleRate);
     }
+    globalLFOBuffer.setSize(numLFOs, jmax(1, samplesPerBlock));
+    globalLFOBuffer.clear();
+    subBlockMidi.ensureSize(2048);     //Room for the midi of a split block so the audio thread does not allocate it
+    
+    //Initalising the voice pool, its filter bank and every voice with the current parameters
+    setParamTargets();
+    mySynth.prepareVoices(sampleRate, &globalLFOBuffer, getChannelLayoutOfBus(false, 0));
+    mySynth.setEnvCurve(*envCurveParam);
+    prevEnvCurve = *envCurveParam;
+    paramsChangedLastBlock = false;
+    
+    //Starting at full quality, set on the first block
+    governor.reset();
+    qualityStage = -1;
     
 
 }
@@ -281,9 +339,13 @@ bool PostBoxSynthesiserProcessor::isBusesLayoutSupported (const BusesLayout& lay
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
+    // Mono, stereo and the quad, 5.1 and 7.1 surround layouts are supported.
+    const AudioChannelSet& output = layouts.getMainOutputChannelSet();
+    if (output != AudioChannelSet::mono()
+     && output != AudioChannelSet::stereo()
+     && output != AudioChannelSet::quadraphonic()
+     && output != AudioChannelSet::create5point1()
+     && output != AudioChannelSet::create7point1())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -299,26 +361,97 @@ bool PostBoxSynthesiserProcessor::isBusesLayoutSupported (const BusesLayout& lay
 
 void PostBoxSynthesiserProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
-    //Checking if parameters updated
-    bool updateParams = false;  //Ensure update params intially false and only activated if params updated
-    if(paramsUpdated)
+    //Flush denormals to zero while rendering, silent filter and envolope tails would otherwise slow the voices that are ending
+    ScopedNoDenormals noDenormals;
+    
+    //A block bigger than prepareToPlay was told about is rendered in parts the global LFO buffer can hold, so the
+    //buffer never has to be resized on the audio thread
+    const int maxBlockSize = globalLFOBuffer.getNumSamples();
+    if(buffer.getNumSamples() <= maxBlockSize)
     {
-        paramsUpdated = false;
-        updateParams = true;    //Mark update params value as true
+        renderBlock(buffer, midiMessages);
+        return;
     }
     
-    for(int i=0; i < numVoices; ++i)    //Iterating through each synth voice
+    for(int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
     {
-        
-        PostBoxSynth* v = dynamic_cast<PostBoxSynth*>(mySynth.getVoice(i));
-        if(updateParams)    //If parameters updated then set the params for each voice
-        {
-            v -> setParams(envolopeParams, oscillatorParams, lfoParams, filterParams, paramEnvChoice);
-        }
+        const int numSamples = jmin(maxBlockSize, buffer.getNumSamples() - start);
+        AudioBuffer<float> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+        subBlockMidi.clear();
+        subBlockMidi.addEvents(midiMessages, start, numSamples, -start);
+        renderBlock(subBlock, subBlockMidi);
     }
-    //Rendering synths next block
+}
+
+void PostBoxSynthesiserProcessor::renderBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    //The block has to be finished within its length, the time taken is measured against that for the quality governor
+    const int64 blockStartTicks = Time::getHighResolutionTicks();
+    const double blockTime = getSampleRate() > 0 ? buffer.getNumSamples() / getSampleRate() : 0.0;
+    
+    //Lowering the quality if the last blocks came too close to their deadline
+    const int stage = governor.getStage();
+    if(stage != qualityStage)
+    {
+        qualityStage = stage;
+        mySynth.setRenderQuality(stage >= QualityGovernor::coarseControl ? QualityGovernor::coarseControlInterval : 1, stage >= QualityGovernor::releasedFiltersOff);
+    }
+    
+    //Reading parameters at the block boundary, if they also changed last block the host is automating them
+    //so the change is ramped linearly over this block to land on the value at the end of the block
+    const bool updateParams = setParamTargets();
+    const int rampSamples = (updateParams && paramsChangedLastBlock) ? buffer.getNumSamples() : 0;
+    paramsChangedLastBlock = updateParams;
+    
+    //Checking if envolope curve changed
+    bool updateEnvCurve = false;
+    if(prevEnvCurve != *envCurveParam)
+    {
+        prevEnvCurve = *envCurveParam;
+        updateEnvCurve = true;
+    }
+    
+    //Setting the polyphony, new notes steal voices once it is reached, at the lowest quality it is halved
+    int polyphony = roundToInt(polyphonyParam -> load());
+    if(stage >= QualityGovernor::polyphonyCapped)
+        polyphony = jmax(1, polyphony / 2);
+    mySynth.setPolyphony(polyphony);
+    
+    //Setting the surround depth of each source, the voices pick it up with their next block of speaker gains
+    for(int i = 0; i < numOscs; ++i)
+        mySynth.setSourceDepth(i, blockParamValues[depthParamStart + i]);
+    
+    if(updateParams)    //If parameters updated then set the params for each playing voice, the others catch up when they start
+    {
+        mySynth.updateVoiceParams(rampSamples);
+    }
+    if(updateEnvCurve)  //If envolope curve changed then set it for each voice, applied at the voices next envolope block
+    {
+        mySynth.setEnvCurve(prevEnvCurve);
+    }
+    
+    //With no voice playing and no midi to start one the block is silent, clearing the buffer marks
+    //it as cleared for the host and the global LFOs, voices and gain are skipped
+    if(mySynth.getNumActiveVoices() == 0 && midiMessages.isEmpty())
+    {
+        buffer.clear();
+        prevGain = *gainParam;  //No samples to ramp the gain over
+        governor.update(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStartTicks), blockTime);
+        return;
+    }
+    
+    //Rendering global LFOs once for all voices
+    renderGlobalLFOs(buffer.getNumSamples());
+    
+    //Rendering synths next block, the render workers shared with other instances take the voices
+    //of the instance with the least time left first
+    mySynth.setRenderDeadline(blockStartTicks + Time::secondsToHighResolutionTicks(blockTime));
     mySynth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
     
+   #if JUCE_DEBUG
+    collectDenormalCounts();
+   #endif
+    
     //Applying master gain to samples
     if(prevGain!=*gainParam)    //Checking if gain has changed
     {
@@ -330,6 +463,30 @@ void PostBoxSynthesiserProcessor::processBlock (AudioBuffer<float>& buffer, Midi
         buffer.applyGain(0, buffer.getNumSamples(), prevGain);  //Otherwise just apply previous gain
     }
     
+    //Measuring the load of the block, a change of stage is applied at the start of the next block
+    governor.update(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStartTicks), blockTime);
+}
+
+void PostBoxSynthesiserProcessor::collectDenormalCounts()
+{
+    int counts[PostBoxSynth::numDenormalStages] = {0, 0, 0, 0};
+    for(int i = 0; i < mySynth.getNumVoices(); ++i)  //Adding up the counts of every voice
+    {
+        PostBoxSynth* v = mySynth.getPoolVoice(i);
+        for(int stage = 0; stage < PostBoxSynth::numDenormalStages; ++stage)
+            counts[stage] += v -> getDenormalCount(stage);
+        v -> resetDenormalCounts();
+    }
+    
+    //Adding to the counts until the message thread takes them, nothing is reported from the audio thread
+    for(int stage = 0; stage < PostBoxSynth::numDenormalStages; ++stage)
+        denormalCounts[stage] += counts[stage];
+}
+
+int PostBoxSynthesiserProcessor::takeDenormalCount(int stage)
+{
+    jassert(stage >= 0 && stage < PostBoxSynth::numDenormalStages);
+    return denormalCounts[stage].exchange(0);
 }
 
 //==============================================================================
@@ -350,10 +507,22 @@ void PostBoxSynthesiserProcessor::getStateInformation (MemoryBlock& destData)
     //Getting saved parameters
     auto state = parameters.copyState();
     std::unique_ptr<XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
     
-    setParamTargets();
-    paramsUpdated = true;
+    //Saving the morph snapshots alongside the parameters
+    XmlElement* morphXml = xml -> createNewChildElement(morphTag);
+    for(int slot = 0; slot < numMorphSnapshots; ++slot)
+    {
+        if(morphSnapshotStored[slot])   //Only save snapshots that have been stored
+        {
+            XmlElement* snapshotXml = morphXml -> createNewChildElement(morphSnapshotTag + String(slot));
+            for(int i = 0; i < paramIDs.size(); ++i)
+            {
+                snapshotXml -> setAttribute(Identifier(paramIDs[i]), morphSnapshots[slot][i].load());
+            }
+        }
+    }
+    
+    copyXmlToBinary (*xml, destData);
 }
 
 void PostBoxSynthesiserProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -362,7 +531,20 @@ void PostBoxSynthesiserProcessor::setStateInformation (const void* data, int siz
     std::unique_ptr<XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName (parameters.state.getType()))
+        {
+            //Clearing the last presets snapshots first, a preset saved before morphing or with one
+            //snapshot would otherwise morph towards snapshots it never had
+            for(int slot = 0; slot < numMorphSnapshots; ++slot)
+                morphSnapshotStored[slot] = false;
+            
+            //Loading the morph snapshots and removing them so they are not added to the parameter tree
+            if(XmlElement* morphXml = xmlState -> getChildByName(morphTag))
+            {
+                loadMorphSnapshots(*morphXml);
+                xmlState -> removeChildElement(morphXml, true);
+            }
             parameters.replaceState (ValueTree::fromXml (*xmlState));
+        }
 }
 
 //==============================================================================
@@ -372,66 +554,267 @@ AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new PostBoxSynthesiserProcessor();
 }
 
-void PostBoxSynthesiserProcessor::setParamTargets()
+void PostBoxSynthesiserProcessor::addParamPointer(const String& paramName)
 {
+    paramIDs.add(paramName);
+    paramPointers.add(parameters.getRawParameterValue(paramName));
     
-    //Getting all envolope parameters
-    for(int i = 0; i < envolopeParams.size(); ++i)
+    //Working out how the parameter is morphed from its type
+    RangedAudioParameter* param = parameters.getParameter(paramName);
+    if(dynamic_cast<AudioParameterChoice*>(param) != nullptr)
     {
-        float adsr[4];
-        for(int j=0; j < 4; ++j)
+        paramMorphTypes.add(morphSwitch);   //Choices can not be inbetween values so switch at the crossfade point
+    }
+    else if(dynamic_cast<AudioParameterInt*>(param) != nullptr)
+    {
+        paramMorphTypes.add(morphStepped);  //Whole number parameters are morphed and rounded
+    }
+    else
+    {
+        paramMorphTypes.add(morphLinear);
+    }
+}
+
+void PostBoxSynthesiserProcessor::cacheParamPointers()
+{
+    //Envolope parameters, only the parameter envolopes have a 5th choice parameter
+    envParamStart = paramPointers.size();
+    for(int i = 0; i < numEnvs; ++i)
+    {
+        for(int j = 0; j < 5; ++j)
+        {
+            if(j < 4 || i >= 3)
+            {
+                addParamPointer(paramID.getEnvolopeParamName(i, j));
+            }
+            else    //Keep the spacing the same for every envolope
+            {
+                paramIDs.add(String());
+                paramPointers.add(nullptr);
+                paramMorphTypes.add(morphSwitch);
+            }
+        }
+    }
+    
+    //Oscillator parameters
+    oscParamStart = paramPointers.size();
+    for(int i = 0; i < numOscs; ++i)
+    {
+        for(int j = 0; j < 5; ++j)
         {
-            adsr[j] = *parameters.getRawParameterValue(paramID.getEnvolopeParamName(i, j));     //Getting envolope parameter
+            addParamPointer(paramID.getOscParamName(i, j));
         }
-        envolopeParams[i] -> setParams(adsr[0], adsr[1], adsr[2], adsr[3]); //Updating this envolopes parameter
+    }
+    
+    //LFO parameters, depth and frequency followed by shape and mode
+    lfoParamStart = paramPointers.size();
+    for(int i = 0; i < numLFOs; ++i)
+    {
+        for(int j = 0; j < 2; ++j)
+        {
+            addParamPointer(paramID.getLfoParamName(i, j));
+        }
+        for(int j = 0; j < 2; ++j)
+        {
+            addParamPointer(paramID.getLfoChoiceParamName(i, j));
+        }
+    }
+    
+    //Filter parameters, mode, frequency and resonance
+    filterParamStart = paramPointers.size();
+    for(int i = 0; i < numFilters; ++i)
+    {
+        for(int j = 0; j < 3; ++j)
+        {
+            addParamPointer(paramID.getFilterParamName(i, j));
+        }
+    }
+    
+    //Drive parameters, mode and amount
+    driveParamStart = paramPointers.size();
+    for(int j = 0; j < 2; ++j)
+    {
+        addParamPointer(paramID.getDriveParamName(j));
+    }
+    
+    //Surround depth parameters, one per oscillator
+    depthParamStart = paramPointers.size();
+    for(int i = 0; i < numOscs; ++i)
+    {
+        addParamPointer("osc" + String(i + 1) + "Depth");
+    }
+    
+    //Parameters the parameter envolopes can control
+    maxParamStart = paramPointers.size();
+    for(int i = 0; i < paramID.numMaxParams; ++i)
+    {
+        addParamPointer(paramID.getMaxParamName(i));
+    }
+    
+    //Allocating the block values and the morph snapshots now the number of parameters is known
+    blockParamValues.calloc(paramPointers.size());
+    for(int slot = 0; slot < numMorphSnapshots; ++slot)
+    {
+        morphSnapshots[slot].reset(new std::atomic<float>[paramPointers.size()]);
+        for(int i = 0; i < paramPointers.size(); ++i)
+        {
+            morphSnapshots[slot][i] = 0.0f;
+        }
+    }
+}
+
+void PostBoxSynthesiserProcessor::storeMorphSnapshot(int slot)
+{
+    if(slot < 0 || slot >= numMorphSnapshots)
+        return;
+    
+    for(int i = 0; i < paramPointers.size(); ++i)   //Copying the current parameter values into the snapshot
+    {
+        morphSnapshots[slot][i] = paramPointers[i] != nullptr ? paramPointers[i] -> load() : 0.0f;
+    }
+    morphSnapshotStored[slot] = true;
+}
+
+bool PostBoxSynthesiserProcessor::hasMorphSnapshot(int slot) const
+{
+    return slot >= 0 && slot < numMorphSnapshots && morphSnapshotStored[slot];
+}
+
+void PostBoxSynthesiserProcessor::loadMorphSnapshots(const XmlElement& morphXml)
+{
+    for(int slot = 0; slot < numMorphSnapshots; ++slot)
+    {
+        if(XmlElement* snapshotXml = morphXml.getChildByName(morphSnapshotTag + String(slot)))
+        {
+            for(int i = 0; i < paramPointers.size(); ++i)
+            {
+                if(paramPointers[i] != nullptr) //Parameters missing from the snapshot keep their current value
+                {
+                    morphSnapshots[slot][i] = (float) snapshotXml -> getDoubleAttribute(paramIDs[i], paramPointers[i] -> load());
+                }
+            }
+            morphSnapshotStored[slot] = true;
+        }
+    }
+}
+
+void PostBoxSynthesiserProcessor::readBlockParamValues()
+{
+    const int numParams = paramPointers.size();
+    
+    //Only morph when morphing is on and both snapshots have been stored
+    if(*morphModeParam < 0.5f || ! morphSnapshotStored[0] || ! morphSnapshotStored[1])
+    {
+        for(int i = 0; i < numParams; ++i)  //Reading the current parameter values
+        {
+            blockParamValues[i] = paramPointers[i] != nullptr ? paramPointers[i] -> load() : 0.0f;
+        }
+        return;
+    }
+    
+    const float morph = *morphParam;
+    const bool pastCrossfade = morph >= morphCrossfadePoint;
+    
+    for(int i = 0; i < numParams; ++i)  //Interpolating between the snapshots
+    {
+        const float a = morphSnapshots[0][i];
+        const float b = morphSnapshots[1][i];
+        
+        switch(paramMorphTypes[i])
+        {
+            case morphSwitch:
+                blockParamValues[i] = pastCrossfade ? b : a;
+                break;
+            case morphStepped:
+                blockParamValues[i] = (float) roundToInt(a + (b - a) * morph);
+                break;
+            case morphLinear:
+            default:
+                blockParamValues[i] = a + (b - a) * morph;
+                break;
+        }
+    }
+}
+
+bool PostBoxSynthesiserProcessor::setParamTargets()
+{
+    bool changed = false;
+    
+    //Getting this blocks parameter values, either from the parameters or the morph
+    readBlockParamValues();
+    
+    //Getting all envolope parameters
+    for(int i = 0; i < envolopeParams.size(); ++i)
+    {
+        const float* adsr = blockParamValues + envParamStart + i * 5;     //Getting envolope parameters
+        changed |= envolopeParams[i] -> setParams(adsr[0], adsr[1], adsr[2], adsr[3]); //Updating this envolopes parameter
     }
     
     //Getting all oscillator parameters
     for(int i = 0; i < oscillatorParams.size(); ++i)
     {
-        int oscChoicePar[1] = {(int)*parameters.getRawParameterValue(paramID.getOscParamName(i, 0))};   //Getting choice param
+        const float* oscVals = blockParamValues + oscParamStart + i * 5;
+        int oscChoicePar[1] = {(int)oscVals[0]};   //Getting choice param
         float oscPar[4] = {1, 1, 0.01f ,0.01f};
         for(int j=0; j < 4; ++j)
         {
-            oscPar[j] = oscPar[j] * (*parameters.getRawParameterValue(paramID.getOscParamName(i, j+1)));    //Getting oscillator parameters
+            oscPar[j] = oscPar[j] * oscVals[j+1];    //Getting oscillator parameters
         }
-        oscillatorParams[i] -> setParams(oscChoicePar, oscPar);     //Updating oscillator parameters
+        changed |= oscillatorParams[i] -> setParams(oscChoicePar, oscPar);     //Updating oscillator parameters
     }
     
     //Getting LFO parameters
     for(int i = 0; i < lfoParams.size(); ++i)
     {
-        float lfoPar[2];
-        for(int j = 0; j < 2; ++j)
-        {
-            lfoPar[j] = (*parameters.getRawParameterValue(paramID.getLfoParamName(i, j)));  //Getting most recent LFO params
-        }
-        lfoParams[i] -> setParams(lfoPar);  //Updating lfo params
+        const float* lfoVals = blockParamValues + lfoParamStart + i * 4;
+        float lfoPar[2] = {lfoVals[0], lfoVals[1]};  //Getting most recent LFO params
+        int lfoChoicePar[2] = {(int)lfoVals[2], (int)lfoVals[3]};  //Getting LFO shape and mode
+        changed |= lfoParams[i] -> setParams(lfoChoicePar, lfoPar);  //Updating lfo params
     }
     
     //Getting filter parameters
     for(int i = 0; i < filterParams.size(); ++i)
     {
-        int choiceParam[1] = {(int)*parameters.getRawParameterValue(paramID.getFilterParamName(i, 0))}; //Getting filter choice value
-        float filterPar[1]= {*parameters.getRawParameterValue(paramID.getFilterParamName(i, 1))};   //Getting filter frequency value
-        filterParams[i] -> setParams(choiceParam, filterPar);   //Updating filter parameters
+        const float* filterVals = blockParamValues + filterParamStart + i * 3;
+        int choiceParam[1] = {(int)filterVals[0]}; //Getting filter choice value
+        float filterPar[2]= {filterVals[1], filterVals[2]};   //Getting filter frequency and resonance values
+        changed |= filterParams[i] -> setParams(choiceParam, filterPar);   //Updating filter parameters
     }
     
+    //Getting drive parameters
+    int driveChoicePar[1] = {(int)blockParamValues[driveParamStart]};   //Getting drive mode
+    float drivePar[1] = {blockParamValues[driveParamStart + 1]};        //Getting drive amount
+    changed |= driveParams.setParams(driveChoicePar, drivePar);         //Updating drive parameters
+    
     //Getting Param Envolope choice parameters
     for(int i = 0; i < numEnvs - 3; ++i)
     {
-        int paramEnvChosen[1] = {(int)*parameters.getRawParameterValue(paramID.getEnvolopeParamName(3+i, 4))}; //Getting Param Env choice
+        int paramEnvChosen[1] = {(int)blockParamValues[envParamStart + (3 + i) * 5 + 4]}; //Getting Param Env choice
         float paramEnvMax[1] = {0};
         if(paramEnvChosen[0] > 0 && paramEnvChosen[0] < paramID.numMaxParams+1)   //Getting the specific parameter value that the choice is pointing to if in range
         {
-            paramEnvMax[0] = *parameters.getRawParameterValue(paramID.getMaxParamName(paramEnvChosen[0]-1));
+            paramEnvMax[0] = blockParamValues[maxParamStart + paramEnvChosen[0]-1];
         }
-        paramEnvChoice[i] -> setParams(paramEnvChosen, paramEnvMax);         //Updating Param Env parameters
+        changed |= paramEnvChoice[i] -> setParams(paramEnvChosen, paramEnvMax);         //Updating Param Env parameters
     }
+    
+    return changed;
 }
 
-void PostBoxSynthesiserProcessor::valueTreePropertyChanged(ValueTree& valTree, const Identifier& property)
+void PostBoxSynthesiserProcessor::renderGlobalLFOs(int numSamples)
 {
-    setParamTargets();      //Update params if the the parameters have changed
-    paramsUpdated = true;   //Set parameters as updated
+    jassert(numSamples <= globalLFOBuffer.getNumSamples());   //processBlock splits blocks bigger than the buffer
+    
+    for(int i = 0; i < numLFOs; ++i)
+    {
+        //Only render LFOs in global mode that have some depth, a voice still smoothing its depth down to 0 after the
+        //depth was set to 0 keeps reading the LFO until it gets there
+        const bool globalMode = lfoParams[i] -> getChoiceParams(1) == 1;
+        if(globalMode && (lfoParams[i] -> getParams(0) > 0.0001f || mySynth.globalLFOInUse(i)))
+        {
+            globalLFOs[i] -> setShape(lfoParams[i] -> getChoiceParams(0));
+            globalLFOs[i] -> setFrequency(lfoParams[i] -> getParams(1));
+            globalLFOs[i] -> renderBlock(globalLFOBuffer.getWritePointer(i), numSamples);
+        }
+    }
 }
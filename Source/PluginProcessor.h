@@ -15,6 +15,7 @@
 #include "PostBoxSynth.h"
 #include "ParamNames.h"
 #include "ParamStore.h"
+#include "QualityGovernor.h"
 
 //==============================================================================
 /**
@@ -31,8 +32,7 @@
  @namespace none
  @updated 2020-04-24
  */
-class PostBoxSynthesiserProcessor  : public AudioProcessor,
-                                   public ValueTree::Listener
+class PostBoxSynthesiserProcessor  : public AudioProcessor
 {
 public:
     //==============================================================================
@@ -73,20 +73,52 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     /**
-     * Updates the parameter arrays with update parameter values
+     * Updates the parameter arrays with update parameter values, called from the audio thread
+     * at the start of every block so host automation is picked up at each block boundary
+     *
+     * @return true if any parameter changed since the last call
+     *
+    */
+    bool setParamTargets();
+    
+    /**
+     * Stores the current value of every synth parameter as a morph snapshot
+     *
+     * @param slot is the snapshot to store, 0 is the start of the morph and 1 is the end
+     *
+    */
+    void storeMorphSnapshot(int slot);
+    
+    /**
+     * Checks if a morph snapshot has been stored
+     *
+     * @param slot is the snapshot to check
+     *
+     * @return true if the snapshot has been stored
      *
     */
-    void setParamTargets();
+    bool hasMorphSnapshot(int slot) const;
     
     /**
-     * Called when any parmeter in the value tree is updated, to ensire that parameters are passed to the synth when updated
-     * and avoid passing them when they have not changed. Is an override required when inheriting from the value tree lisetener class
+     * Gets the governor that lowers the render quality when blocks come close to their deadline,
+     * its thresholds and hold time can be changed from the message thread while audio is running
      *
-     * @param treeWhosePropertyhasChanged tells which value tree has changed
-     * @param propery tells which value tree property has cahnged
+     * @return the quality governor
      *
     */
-    void valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, const Identifier& property) override;
+    QualityGovernor& getQualityGovernor() { return governor; }
+    
+    /**
+     * Gets the number of denormal results a voice stage produced since the last call and clears it,
+     * the counts are only made in debug builds
+     *
+     * @param stage is one of the values in PostBoxSynth::DenormalStage
+     *
+     * @return the number of denormal results
+     *
+    */
+    int takeDenormalCount(int stage);
+    
     //Parameters
     AudioProcessorValueTreeState parameters;
     ParamNames paramID;
@@ -95,28 +127,142 @@ private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PostBoxSynthesiserProcessor)
     
-    int numVoices = 8; //Setting number of synth voices
+    /**
+     * Renders a block no longer than the block size given to prepareToPlay, processBlock splits bigger blocks into these
+     *
+     * @param buffer is the block of the output to render
+     * @param midiMessages is the midi of the block with its times from the start of the block
+     *
+    */
+    void renderBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+    
+    /**
+     * Renders the LFOs that are in global mode once for all voices to read
+     *
+     * @param numSamples is the number of samples in the block, no more than the size of the LFO buffer
+     *
+    */
+    void renderGlobalLFOs(int numSamples);
+    
+    /**
+     * Adds the number of denormal results each voice stage produced in the last block to
+     * the counts takeDenormalCount reads, only called in debug builds
+     *
+    */
+    void collectDenormalCounts();
+    
+    /**
+     * Looks up the raw value of every parameter the voices use once so
+     * setParamTargets does not need to search for parameters by name each block
+     *
+    */
+    void cacheParamPointers();
+    
+    /**
+     * Adds a parameter to the cached parameters
+     *
+     * @param paramName is the ID of the parameter
+     *
+    */
+    void addParamPointer(const String& paramName);
     
-    std::atomic<bool> paramsUpdated {false};
+    /**
+     * Fills the block parameter values from the parameters, or from the
+     * morph snapshots if morphing is on
+     *
+    */
+    void readBlockParamValues();
+    
+    /**
+     * Loads the morph snapshots from a saved state
+     *
+     * @param morphXml is the xml element the snapshots were saved to
+     *
+    */
+    void loadMorphSnapshots(const XmlElement& morphXml);
+    
+    //Set when parameters changed in the last block, a change that carries on into the next block
+    //is taken as host automation and ramped over the whole block rather than the smoothing time
+    bool paramsChangedLastBlock = false;
+    
+    //Memory the voices are built in, declared before the synthesiser so it outlives the voices
+    VoiceArena voiceArena;
     
     //Synthesiser
-    Synthesiser mySynth;
+    PostBoxSynthesiser mySynth;
     
-    //Defining the number of each type used in the synth
-    int numOscs = 4;
-    int numEnvs = 8;
-    int numLFOs = 1;
-    int numFilters = 2;
+    //Measures the load of each block and picks the quality stage, and the stage the synth was last set to
+    QualityGovernor governor;
+    int qualityStage = -1;
+    
+    //Defining the number of each type used in the synth, taken from the voice so the parameters always match it
+    static constexpr int numOscs = PostBoxSynth::numSources;
+    static constexpr int numEnvs = PostBoxSynth::numEnvs;
+    static constexpr int numLFOs = PostBoxSynth::numLFOs;
+    static constexpr int numFilters = PostBoxSynth::numFilters;
     
     //Atomic float to point to gain parameter
     std::atomic<float>* gainParam;
     float prevGain = 1; //Parameter for storing previous gain
     
+    //Atomic float to point to polyphony parameter
+    std::atomic<float>* polyphonyParam;
+    
+    //Atomic float to point to envolope curve parameter
+    std::atomic<float>* envCurveParam;
+    float prevEnvCurve = -1; //Parameter for storing previous envolope curve, -1 so it is set on the first block
+    
     //Defining owned arrays for storing the parameters
     OwnedArray<EnvolopeParams> envolopeParams;
     OwnedArray<SimpleParams> oscillatorParams;
     OwnedArray<SimpleParams> lfoParams;
     OwnedArray<SimpleParams> filterParams;
+    SimpleParams driveParams {1, 1};
     OwnedArray<SimpleParams> paramEnvChoice;
     
+    //Cached parameters stored flat, each group starts at its start index and is laid out as [item * parameters per item + parameter]
+    StringArray paramIDs;
+    Array<std::atomic<float>*> paramPointers;
+    int envParamStart = 0;      //5 per envolope, the 5th is only used by the parameter envolopes
+    int oscParamStart = 0;      //5 per oscillator
+    int lfoParamStart = 0;      //4 per LFO, depth, frequency, shape and mode
+    int filterParamStart = 0;   //3 per filter
+    int driveParamStart = 0;    //Mode and amount
+    int depthParamStart = 0;    //Surround depth of each oscillator
+    int maxParamStart = 0;      //Parameters a parameter envolope can point to
+    
+    //Parameter values used for the current block
+    HeapBlock<float> blockParamValues;
+    
+    //How each parameter is morphed
+    enum MorphType
+    {
+        morphLinear = 0,    //Interpolated
+        morphStepped,       //Interpolated and rounded to a whole number
+        morphSwitch         //Switches from the start to the end value at the crossfade point
+    };
+    Array<int> paramMorphTypes;
+    
+    //Morph snapshots, written by the message thread and read by the audio thread
+    static constexpr int numMorphSnapshots = 2;
+    static constexpr float morphCrossfadePoint = 0.5f;
+    std::unique_ptr<std::atomic<float>[]> morphSnapshots[numMorphSnapshots];
+    std::atomic<bool> morphSnapshotStored[numMorphSnapshots] {{false}, {false}};
+    const String morphTag = "MorphSnapshots";
+    const String morphSnapshotTag = "Snapshot";
+    
+    //Atomic floats to point to the morph parameters
+    std::atomic<float>* morphModeParam;
+    std::atomic<float>* morphParam;
+    
+    //Denormal results of each voice stage since they were last taken, only counted in debug builds
+    std::atomic<int> denormalCounts[PostBoxSynth::numDenormalStages] {{0}, {0}, {0}, {0}};
+    
+    //LFOs in global mode rendered once per block and the buffer they are rendered to, sized by prepareToPlay
+    OwnedArray<SynthLFO> globalLFOs;
+    AudioBuffer<float> globalLFOBuffer;
+    
+    //Midi of each part of a block bigger than the one prepareToPlay was given
+    MidiBuffer subBlockMidi;
+    
 };
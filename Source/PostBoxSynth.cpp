@@ -12,71 +12,86 @@
 
 #include "PostBoxSynth.h"
 
-PostBoxSynth::PostBoxSynth(int numOscs, int numEnvs, int numFilters)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::PostBoxSynthVoice()
 {
-
-    for(int i = 0; i < numOscs; ++i)  //Initialising an owned array of oscillator parameter smoothers
-    {
-        smoothOscParams.add(new MultiSmooth(4));
-    }
-        
-    for(int i = 0; i < numEnvs; ++i)  //Initialising an owned array of env parameter smoothers and ADSRs
-    {
-        smoothEnvParams.add(new MultiSmooth());
-        myEnvs.add(new ADSR());
-    }
-        
-    for(int i = 0; i < numFilters; ++i) //Initialising an owned array of filter parameter smoothers, adding filters and intialising filter types
-    {
-        auto* filter = synthFilters.add(new StereoIIRFilters());
-        filter -> setFilterType(i == 1);
-        smoothFilterParams.add(new SmoothChanges());
-    }
-        
-    smoothLFOParams.add(new MultiSmooth(2));    //intialising smoother for LFO parameters
+    for(auto& smoother : smoothOscParams)   //Tune, pan, min and max volume for each oscillator
+        smoother.setNumParams(4);
+    
+    for(auto& smoother : smoothLFOParams)   //Depth and frequency for each LFO
+        smoother.setNumParams(2);
     
-    for(int i = 0; i < 12; ++i) //Intialises max param values smoother
+    for(int i = 0; i < NumFilters; ++i) //Intialising filter types, the first filter is a low pass and the others are high passes
     {
-        maxParamsVals.add(new SmoothChanges());
+        frontFilters.synthFilters[i].setFilterType(i > 0);
+        frontFilters.svFilters[i].setFilterType(i > 0 ? ZDFStateVariableFilter::highPass : ZDFStateVariableFilter::lowPass);
+        filterOrder[i] = 1;
+        filterCutoff[i] = 1000.0f;
     }
-        
+    
+    for(int i = 0; i < NumLFOs; ++i)    //Pointing at the voices own LFO blocks until a global LFO is used
+        lfoVals[i] = lfoBlock[i];
+    
+    //Stereo until setNumChannels is called, the surround channels are only pointed at when they are allocated
+    voiceChannels[0] = voiceBlock[0];
+    voiceChannels[1] = voiceBlock[1];
+    pairFilters[0] = &frontFilters;
+    
+    resetParamSwitches();   //Every parameter is set by the first call to setParams
 }
 
 
-void PostBoxSynth::setSampleRate(float sampleRate)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setSampleRate(float sampleRate)
 {
-    for(int i = 0; i < smoothOscParams.size(); ++i) //Setting sample rate for oscillators and their parameter smoothers
+    sourceOscs.setSampleRate(sampleRate);   //Setting sample rate for oscillators and their parameter smoothers
+    for(int i = 0; i < NumSources; ++i)
     {
-        smoothOscParams[i] -> setSampleRate(sampleRate);
-        sourceOscs.setSampleRate(sampleRate);
+        smoothOscParams[i].setSampleRate(sampleRate);
     }
         
-    for(int i = 0; i < smoothEnvParams.size(); ++i) //Setting sample rate for envolopess and their parameter smoothers
+    for(int i = 0; i < NumEnvs; ++i) //Setting sample rate for envolope parameter smoothers
     {
-        smoothEnvParams[i] -> setSampleRate(sampleRate);
-        myEnvs[i] -> setSampleRate(sampleRate);
+        smoothEnvParams[i].setSampleRate(sampleRate);
     }
+    envBank.setSampleRate(sampleRate);  //Setting sample rate for the envolopes
         
-    for(int i = 0; i < smoothFilterParams.size(); ++i) //Setting sample rate for filters and their parameter smoothers
+    for(int i = 0; i < NumFilters; ++i) //Setting sample rate for filters and their parameter smoothers
     {
-        smoothFilterParams[i] -> setSampleRate(sampleRate);
-        synthFilters[i] -> setSampleRate(sampleRate);
+        smoothFilterParams[i].setSampleRate(sampleRate);
+        for(int p = 0; p < numChannelPairs; ++p)
+        {
+            pairFilters[p] -> synthFilters[i].setSampleRate(sampleRate);
+            pairFilters[p] -> svFilters[i].setSampleRate(sampleRate);
+            pairFilters[p] -> formantFilters[i].setSampleRate(sampleRate);
+        }
     }
         
-    smoothLFOParams[0] -> setSampleRate(sampleRate); //Setting sample rate for lfos and their parameter smoothers
-    lfoOsc.setSampleRate(sampleRate);
+    for(int i = 0; i < NumLFOs; ++i) //Setting sample rate for lfos and their parameter smoothers
+    {
+        smoothLFOParams[i].setSampleRate(sampleRate);
+        voiceLFOs[i].setSampleRate(sampleRate);
+    }
+    
+    smoothDriveAmount.setSampleRate(sampleRate);    //Setting sample rate for the drive amount smoother
     
-    for(int i = 0; i < 12; ++i) //Setting sample rate for max param val smoother
+    for(int i = 0; i < numEnvolopedParams; ++i) //Setting sample rate for max param val smoother
     {
-        maxParamsVals[i] -> setSampleRate(sampleRate);
+        maxParamsVals[i].setSampleRate(sampleRate);
     }
         
 }
 
     
-void PostBoxSynth::setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<SimpleParams>& oscs, OwnedArray<SimpleParams>& lfos, OwnedArray<SimpleParams>& filters, OwnedArray<SimpleParams>& paramEnvsChoice)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<SimpleParams>& oscs, OwnedArray<SimpleParams>& lfos, OwnedArray<SimpleParams>& filters, SimpleParams& drive, OwnedArray<SimpleParams>& paramEnvsChoice, int rampSamples)
 {
-    for(int i = 0; i < envs.size(); ++i)    //Iterating through all envolope parameters
+    paramRampSamples = rampSamples; //Store ramp length for the parameter updates
+    
+    //The parameter arrays are made for this topology
+    jassert(envs.size() == NumEnvs && oscs.size() == NumSources && lfos.size() == NumLFOs && filters.size() == NumFilters && paramEnvsChoice.size() == numParamEnvs);
+    
+    for(int i = 0; i < NumEnvs; ++i)    //Iterating through all envolope parameters
     {
         if(envs[i] -> getValSwitch() != envUpdate[i])   //Check if env updated since last checked
         {
@@ -85,7 +100,7 @@ void PostBoxSynth::setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<Simple
         }
     }
         
-    for(int i = 0; i < oscs.size(); ++i)    //iterating through all oscillator parameters
+    for(int i = 0; i < NumSources; ++i)    //iterating through all oscillator parameters
     {
         if(oscs[i] -> getValSwitch() != oscUpdate[i])   //Check if osc updated since last checked
         {
@@ -95,25 +110,31 @@ void PostBoxSynth::setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<Simple
         }
     }
         
-    for(int i = 0; i < lfos.size(); ++i) //iterating through all lfo
+    for(int i = 0; i < NumLFOs; ++i) //iterating through all lfo
     {
-        if(lfos[i] -> getValSwitch() != lfoUpdate) //Check if lfo updated since last checked
+        if(lfos[i] -> getValSwitch() != lfoUpdate[i]) //Check if lfo updated since last checked
         {
-            updateLFOs(lfos[i] -> getParams(0), lfos[i] -> getParams(1));   //Update lfos with new params
-            lfoUpdate = lfos[i] -> getValSwitch();      //update value switch
+            updateLFOs(i, lfos[i] -> getParams(0), lfos[i] -> getParams(1), lfos[i] -> getChoiceParams(0), lfos[i] -> getChoiceParams(1));   //Update lfos with new params
+            lfoUpdate[i] = lfos[i] -> getValSwitch();      //update value switch
         }
     }
         
-    for(int i = 0; i < filters.size(); ++i)     //iterating through all filters
+    for(int i = 0; i < NumFilters; ++i)     //iterating through all filters
     {
         if(filters[i] -> getValSwitch() != filterUpdate[i])     //check if filter update since last checked
         {
-            updateFilters(i, filters[i] -> getChoiceParams(0), filters[i] -> getParams(0)); //Update filters with new params
+            updateFilters(i, filters[i] -> getChoiceParams(0), filters[i] -> getParams(0), filters[i] -> getParams(1)); //Update filters with new params
             filterUpdate[i] = filters[i] -> getValSwitch(); //update the value switch
         }
     }
+    
+    if(drive.getValSwitch() != driveUpdate)     //check if drive updated since last checked
+    {
+        updateDrive(drive.getChoiceParams(0), drive.getParams(0));  //Update drive with new params
+        driveUpdate = drive.getValSwitch(); //update the value switch
+    }
         
-    for(int i = 0; i < paramEnvsChoice.size(); ++i) //iterating through all parameter envolopes
+    for(int i = 0; i < numParamEnvs; ++i) //iterating through all parameter envolopes
     {
         if(paramEnvsChoice[i] -> getValSwitch() != paramEnvUpdate[i])   //Check if parameter envolopes update since last checked
         {
@@ -124,147 +145,453 @@ void PostBoxSynth::setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<Simple
 }
     
 
-void PostBoxSynth::startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int /*currentPitchWheelPosition*/)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int /*currentPitchWheelPosition*/)
 {
     noteVelocity = velocity;            //Update note velocity param
     
-    for(int i = 0; i < myEnvs.size(); ++i)  // reset all envolopes and set note on
+    envBank.reset();    // reset all envolopes and set note on
+    envBank.noteOn();
+    
+    drive.reset();  //Clear the last input of the drive from the last note
+    panGainsSet = false;    //Surround gains start where the sources are instead of ramping from the last note
+    
+    //Each note starts its filters from silence. The voices bank lanes still hold the last notes tail, which may
+    //have ended part way through a block, so clearing these makes the first block of this note clear the lanes states
+    bankFiltering = false;
+    bankFilteredLastBlock = false;
+    for(int i = 0; i < NumFilters; ++i)
     {
-        myEnvs[i] -> reset();
-        myEnvs[i] -> noteOn();
+        for(int p = 0; p < numChannelPairs; ++p)
+        {
+            pairFilters[p] -> synthFilters[i].resetFilter();
+            pairFilters[p] -> svFilters[i].resetFilter();
+            pairFilters[p] -> formantFilters[i].resetFilter();
+        }
     }
+    
+    for(int i = 0; i < NumLFOs; ++i)    //Retrigger the voices own LFOs
+        voiceLFOs[i].resetPhase();
     sourceOscs.playMode(true);              //Initiate oscillators to play mode
     sourceOscs.setOscsMidiInput(midiNoteNumber);    //set oscillator frequency
     
     //Mark as playing and not released
     released = false;
     playing = true;
+    ampLevel = 1.0f;
         
 }
 
-void PostBoxSynth::stopNote(float /*velocity*/, bool allowTailOff)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::stopNote(float /*velocity*/, bool allowTailOff)
 {
-    for(int i = 0; i < myEnvs.size(); ++i) //Send note off to all envolopes
-        myEnvs[i] -> noteOff();
+    if(!allowTailOff)   //Stop straight away, when the voice is stolen or all notes are stopped
+    {
+        if(playing)
+            resetVoice();
+        return;
+    }
+    
+    envBank.noteOff();  //Send note off to all envolopes
 
     released = true;    //Mark released as true
 }
     
-void PostBoxSynth::renderNextBlock(AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::renderNextBlock(AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
 {
-    // iterate through the all samples
-    for (int sampleIndex = startSample;   sampleIndex < (startSample+numSamples);   sampleIndex++)
+    if(!playing)    //Voices that are not playing a note have nothing to add
+        return;
+    
+    int endSample = startSample + numSamples;
+    
+    // iterate through the samples in envolope sized blocks, filtering with the voices own filters
+    for (int blockStart = startSample; blockStart < endSample; blockStart += envBlockSize)
     {
-        float ampEnv = 0;           //Setting amp envolope to 0 intially
-        float currentSample[2] = {0, 0};    //Setting current sample to 0 intially
+        int blockSamples = jmin(envBlockSize, endSample - blockStart);
+        
+        //Nothing to render if no note is playing, a voice can only start playing bettween calls
+        if(renderVoiceBlock(blockStart, blockSamples, false) == 0)
+            return;
+        
+        finishVoiceBlock(outputBuffer, blockStart);
+    }
+}
 
-        //If note is playing then
-        if(playing)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+int PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::renderVoiceBlock(int blockStart, int blockSamples, bool useFilterBank)
+{
+    bankFilteredLastBlock = bankFiltering;
+    bankFiltering = false;
+    blockPlayed = 0;
+    blockSilent = false;
+    
+    if(!playing)
+        return 0;
+    
+    //Update envolope parameters and render the envolopes and LFOs for this block
+    updateEnvParams(blockSamples);
+    envBank.renderBlock(envBlock, blockSamples);
+   #if JUCE_DEBUG
+    denormalCounts[envDenormals] += Denormals::count(envBlock, blockSamples * EnvelopeBank::numLanes);
+   #endif
+    renderLFOs(blockStart, blockSamples);
+    prepareFilters();
+    prepareDrive();
+    if(numChannels > 2)
+        preparePanning(blockSamples);
+    
+    for(int i = 0; i < NumLFOs; ++i)
+        lfoUsed[i] = false;
+    
+    //Render the oscillators and per sample parameters into the voice block
+    int numPlayed = 0;
+    for (blockPos = 0; blockPos < blockSamples; ++blockPos)
+    {
+        //Point to this samples envolope values
+        envVals = envBlock + blockPos * EnvelopeBank::numLanes;
+        
+        //Update synth parameters, only every few samples when the quality has been lowered
+        if(blockPos % controlInterval == 0)
+            updateParams(jmin(controlInterval, blockSamples - blockPos));
+        
+        //Get next sample from the oscillators
+        float currentSample[maxChannels] = {};
+        oscsNextSample(currentSample);
+        for(int c = 0; c < numChannels; ++c)
+            voiceChannels[c][blockPos] = currentSample[c];
+        
+        //Store this samples LFO depths, depths too small to hear are stored as 0 so they leave the sample unchanged
+        for(int j = 0; j < NumLFOs; ++j)
         {
-            //Update synth parameters
-            updateParams();
-            
-            //Get next sample from the oscillators
-            oscsNextSample(currentSample);
-                
-            //Apply effects to the oscillator samples
-            applyFX(currentSample);
-            
-            //Get amplitude envolope
-            ampEnv = myEnvs[0] -> getNextSample();
-                
-            //Mark as released and reset voice if amplitude envolope is below a threshold
-            if(released && ampEnv<0.0001f)
-            {
-                resetVoice();
-            }
+            const bool lfoOn = lfoAmp[j] > 0.0001f;
+            lfoAmpBlock[j][blockPos] = lfoOn ? lfoAmp[j] : 0.0f;
+            lfoUsed[j] = lfoUsed[j] || lfoOn;
         }
         
-        // for each channel, write the currentSample float to the output
-        for (int chan = 0; chan<outputBuffer.getNumChannels(); chan++)
+        //Store this samples cut off for filters with changing cut offs
+        for(int i = 0; i < NumFilters; ++i)
         {
-            // The output sample is scaled by 0.9 and note velocity so that it is not too loud by default
-            outputBuffer.addSample (chan, sampleIndex, ampEnv * currentSample[chan] * noteVelocity * 0.9);
+            if(filterRamp[i])
+                filterCutoffBlock[i][blockPos] = getParamVal(filterParamDest + i, smoothFilterParams[i].getNextVal());
         }
+        
+        //Store this samples drive amount if it is changing
+        if(driveRamp)
+            driveAmountBlock[blockPos] = getParamVal(driveParamDest, smoothDriveAmount.getNextVal());
+        
+        ++numPlayed;
+        
+        //Mark as released and reset voice if amplitude envolope is below a threshold
+        if(released && envVals[0] < 0.0001f)
+        {
+            resetVoice();
+            break;
+        }
+    }
+    
+   #if JUCE_DEBUG
+    denormalCounts[oscDenormals] += countBlockDenormals(numPlayed);
+   #endif
+    
+    //Sources set to none or turned down give a silent block that the FX can skip
+    blockSilent = checkBlockSilent(numPlayed);
+    
+    //Keep the amp level the block finished on
+    ampLevel = playing ? envBlock[(numPlayed - 1) * EnvelopeBank::numLanes] : 0.0f;
+    
+    //Apply effects to the whole block of oscillator samples
+    applyFX(numPlayed, useFilterBank);
+    
+    blockPlayed = numPlayed;
+    return numPlayed;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::finishVoiceBlock(AudioSampleBuffer& outputBuffer, int blockStart)
+{
+    if(blockPlayed == 0 || blockSilent)     //Nothing to add for silent blocks
+        return;
+    
+    if(bankFiltering)   //Collect the filtered block from the filter bank
+    {
+        filterBank -> readVoice(voiceIndex, voiceChannels, blockPlayed);
+       #if JUCE_DEBUG
+        denormalCounts[filterDenormals] += countBlockDenormals(blockPlayed);
+       #endif
+    }
+    
+    // The output sample is scaled by the amp envolope, 0.9 and note velocity so that it is not too loud by default,
+    // the gains are worked out once for every channel
+    const float outputLevel = noteVelocity * 0.9f;
+    for (int i = 0; i < blockPlayed; ++i)
+        outputGainBlock[i] = envBlock[i * EnvelopeBank::numLanes] * outputLevel;
+    
+    // for each channel, add the voice block to its output channel in one vector operation
+    for (int chan = 0; chan < numChannels; chan++)
+    {
+        if(outputChannels[chan] < outputBuffer.getNumChannels())
+            FloatVectorOperations::addWithMultiply(outputBuffer.getWritePointer(outputChannels[chan], blockStart), voiceChannels[chan], outputGainBlock, blockPlayed);
     }
 }
 
 
-bool PostBoxSynth::canPlaySound (SynthesiserSound* sound)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+bool PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::canPlaySound (SynthesiserSound* sound)
 {
     return dynamic_cast<PostBoxSynthSound*> (sound) != nullptr;
 }
 
-void PostBoxSynth::updateFilters(int filterNum, int filterMode, float filterFreq)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setGlobalLFOBuffer(const AudioBuffer<float>* newGlobalLFOBuffer)
+{
+    globalLFOBuffer = newGlobalLFOBuffer;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+int PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::getDenormalCount(int stage) const
 {
+    return (stage >= 0 && stage < numDenormalStages) ? denormalCounts[stage] : 0;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::resetDenormalCounts()
+{
+    for(int i = 0; i < numDenormalStages; ++i)
+        denormalCounts[i] = 0;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setFilterBank(VoiceFilterBank* newFilterBank, int newVoiceIndex)
+{
+    filterBank = newFilterBank;
+    voiceIndex = newVoiceIndex;
+    bankFiltering = false;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::resetParamSwitches()
+{
+    //4 is never a value switch so every parameter is seen as changed
+    envUpdate.fill(4);
+    oscUpdate.fill(4);
+    lfoUpdate.fill(4);
+    filterUpdate.fill(4);
+    paramEnvUpdate.fill(4);
+    driveUpdate = 4;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setEnvCurve(float newCurve)
+{
+    for(int i = 0; i < NumEnvs; ++i)   //Set curve for all envolopes
+        envBank.setCurve(i, newCurve);
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setRenderQuality(int newControlInterval, bool newDropReleasedFilters)
+{
+    jassert(newControlInterval > 0 && envBlockSize % newControlInterval == 0);
+    controlInterval = jlimit(1, envBlockSize, newControlInterval);
+    dropReleasedFilters = newDropReleasedFilters;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setNumChannels(int newNumChannels, const SurroundPanner* newPanner)
+{
+    numChannels = jlimit(1, maxChannels, newNumChannels);
+    numChannelPairs = (numChannels + 1) / 2;
+    panner = newPanner;
+    jassert(numChannels <= 2 || panner != nullptr);     //Surround voices need the speaker gains
+    
+    //Mono and stereo voices go straight to the first channels, surround channels go to their speakers
+    for(int c = 0; c < maxChannels; ++c)
+        outputChannels[c] = numChannels > 2 && c < numChannels ? panner -> getSpeakerChannel(c) : c;
+    
+    //Only surround voices have the channels and filters past the first pair, this is called off the audio thread
+    //so they are built here. Each surround pair starts as a copy of the first so it has the same filter settings
+    const bool useSurround = numChannels > 2;
+    if(useSurround && surround == nullptr)
+    {
+        surroundArena.reserve(VoiceArena::alignedSize(sizeof(SurroundChannels)));
+        surround = new (surroundArena.allocate(sizeof(SurroundChannels))) SurroundChannels();
+    }
+    
+    for(int p = 1; p < maxChannelPairs; ++p)
+    {
+        pairFilters[p] = useSurround ? &surround -> pairFilters[p - 1] : nullptr;
+        if(useSurround)
+            *pairFilters[p] = frontFilters;
+    }
+    for(int c = 2; c < maxChannels; ++c)
+        voiceChannels[c] = useSurround ? surround -> voiceBlock[c - 2] : nullptr;
+    
+    //The butterworth filters and drive only run the channels in use, the state variable and formant filters
+    //run both channels of a pair as one vector operation so the silent channel of an odd pair costs them nothing
+    for(int i = 0; i < NumFilters; ++i)
+    {
+        for(int p = 0; p < numChannelPairs; ++p)
+        {
+            PairFilters& filters = *pairFilters[p];
+            filters.synthFilters[i].setNumChannels(2 * p + 1 < numChannels ? 2 : 1);
+            filters.synthFilters[i].resetFilter();
+            filters.svFilters[i].resetFilter();
+            filters.formantFilters[i].resetFilter();
+            filters.synthFilters[i].setFilterCutOffFreq(filterCutoff[i]);
+            filters.svFilters[i].setFilterCutOffFreq(filterCutoff[i]);
+        }
+    }
+    drive.setNumChannels(numChannels);
+    
+    for(int c = 0; c < 2 * numChannelPairs; ++c)
+        FloatVectorOperations::clear(voiceChannels[c], envBlockSize);
+    panGainsSet = false;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateFilters(int filterNum, int filterMode, float filterFreq, float filterRes)
+{
+    //The SVF modes come after the butterworth modes, the low pass has -12dB/oct and -24dB/oct and the high pass only -12dB/oct,
+    //the low pass also has the formant mode after its SVF modes
+    const int firstSVFMode = filterNum == 0 ? 3 : 2;
+    const int formantMode = filterNum == 0 ? 6 : -1;
+    const int svfTypes[2][3] = {{ZDFStateVariableFilter::lowPass, ZDFStateVariableFilter::bandPass, ZDFStateVariableFilter::notch},
+                                {ZDFStateVariableFilter::highPass, ZDFStateVariableFilter::bandPass, ZDFStateVariableFilter::notch}};
+    
     if(filterMode != 0) //If filter mode isn't 0 (filter is off)
     {
         filterEnable[filterNum] = true;     //Ensure filter enabled
-        synthFilters[filterNum] -> setFilterOrder(filterMode==2); //setting filter order immediatly
+        const bool useFormant = filterMode == formantMode;
+        const bool useSVF = !useFormant && filterMode >= firstSVFMode;
+        
+        if(useFormant)
+        {
+            if(!filterFormant[filterNum])   //Clear the old state when switching filters
+            {
+                for(int p = 0; p < numChannelPairs; ++p)
+                    pairFilters[p] -> formantFilters[filterNum].resetFilter();
+            }
+        }
+        else if(useSVF)  //Setting the state variable filter output immediatly
+        {
+            for(int p = 0; p < numChannelPairs; ++p)
+            {
+                ZDFStateVariableFilter& filter = pairFilters[p] -> svFilters[filterNum];
+                filter.setFilterType(svfTypes[filterNum == 0 ? 0 : 1][jmin(filterMode - firstSVFMode, 2)]);
+                if(!filterSVF[filterNum])   //Clear the old state when switching filters
+                    filter.resetFilter();
+            }
+        }
+        else        //setting filter order immediatly
+        {
+            filterOrder[filterNum] = filterMode;
+            for(int p = 0; p < numChannelPairs; ++p)
+            {
+                StereoIIRFilters& filter = pairFilters[p] -> synthFilters[filterNum];
+                filter.setFilterOrder(filterMode==2);
+                if(filterSVF[filterNum] || filterFormant[filterNum])
+                    filter.resetFilter();
+            }
+        }
+        filterSVF[filterNum] = useSVF;
+        filterFormant[filterNum] = useFormant;
     }
     else
     {
         filterEnable[filterNum] = false;    //Otherwise disable the filter
     }
+    
+    for(int p = 0; p < numChannelPairs; ++p)     //Resonance is set at the block boundary, the SVF is stable through the jump
+    {
+        pairFilters[p] -> svFilters[filterNum].setResonance(filterRes);
+        pairFilters[p] -> formantFilters[filterNum].setResonance(filterRes);
+    }
         
     if(!playing || !filterEnable[filterNum])    //If not playing or filter not enabled
     {
         //Update filter parameters immediatly, no smoothing needed
-        smoothFilterParams[filterNum] -> init(filterFreq, filterFreq);
-        synthFilters[filterNum] -> setFilterCutOffFreq(filterFreq);
+        smoothFilterParams[filterNum].init(filterFreq, filterFreq);
+        for(int p = 0; p < numChannelPairs; ++p)
+        {
+            pairFilters[p] -> synthFilters[filterNum].setFilterCutOffFreq(filterFreq);
+            pairFilters[p] -> svFilters[filterNum].setFilterCutOffFreq(filterFreq);
+        }
     }
     else
     {
-        smoothFilterParams[filterNum] -> setTargetVal(filterFreq); //Otherwise if playing then set target to desired cutoff
+        smoothFilterParams[filterNum].setTargetVal(filterFreq, paramRampSamples); //Otherwise if playing then set target to desired cutoff
     }
 }
     
-void PostBoxSynth::updateLFOs(float lfoAmp, float lfoFreq)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateDrive(int driveMode, float newDriveAmount)
+{
+    drive.setMode(driveMode);   //Setting the curve immediatly
+    
+    if(!playing || driveMode == ADAADrive::off) //If not playing or drive off update the amount immediatly
+    {
+        smoothDriveAmount.init(newDriveAmount, newDriveAmount);
+        driveAmount = newDriveAmount;
+    }
+    else
+    {
+        smoothDriveAmount.setTargetVal(newDriveAmount, paramRampSamples); //Otherwise smooth to the new amount
+    }
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateLFOs(int lfoNum, float lfoAmp, float lfoFreq, int lfoShape, int lfoMode)
 {
+    voiceLFOs[lfoNum].setShape(lfoShape);  //Setting shape and mode immediatly
+    lfoGlobal[lfoNum] = lfoMode == 1 && globalLFOBuffer != nullptr && lfoNum < globalLFOBuffer -> getNumChannels();
+    
     float lfoPar[2] = {lfoAmp, lfoFreq};
     if(!playing)    //If not playing update parameters no smoothing needed
     {
-        smoothLFOParams[0] -> init(lfoPar, lfoPar);
-        lfoOsc.setFrequency(lfoFreq);
+        smoothLFOParams[lfoNum].init(lfoPar, lfoPar);
+        voiceLFOs[lfoNum].setFrequency(lfoFreq);
     }
     else //Otherwise set target for updated parameters
     {
-        smoothLFOParams[0] -> setTargetVal(lfoPar);
+        smoothLFOParams[lfoNum].setTargetVal(lfoPar, paramRampSamples);
     }
 }
     
-void PostBoxSynth::updateEnv(int envNum, ADSR::Parameters thisADSR)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateEnv(int envNum, ADSR::Parameters thisADSR)
 {
     float adsrParams[4] = {thisADSR.attack, thisADSR.decay, thisADSR.sustain, thisADSR.release};
 
     //Update env no smoothing needed if not playing
     if(!playing)
     {
-        smoothEnvParams[envNum] -> init(adsrParams ,adsrParams);
+        smoothEnvParams[envNum].init(adsrParams ,adsrParams);
         setADSR(envNum, adsrParams);
     }
     else //Set desired adsr as target if playing
     {
-        smoothEnvParams[envNum] -> setTargetVal(adsrParams);
+        smoothEnvParams[envNum].setTargetVal(adsrParams, paramRampSamples);
     }
 }
         
-void PostBoxSynth::updateOsc(int oscNum, float newTune, float newPan, float newMinAmp, float newMaxAmp)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateOsc(int oscNum, float newTune, float newPan, float newMinAmp, float newMaxAmp)
 {
     float oscParams[4] = {newTune, newPan, newMinAmp, newMaxAmp};
         
     //Update osc with no smoothing if not playing
     if(!playing)
     {
-        smoothOscParams[oscNum] -> init(oscParams, oscParams);
+        smoothOscParams[oscNum].init(oscParams, oscParams);
     }
     else //otherwise set desired osc params as target if it is playing
     {
-        smoothOscParams[oscNum] -> setTargetVal(oscParams);
+        smoothOscParams[oscNum].setTargetVal(oscParams, paramRampSamples);
     }
 }
 
-void PostBoxSynth::updateParamEnvs(int paramEnvNum, int envChoice, float paramResult)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateParamEnvs(int paramEnvNum, int envChoice, float paramResult)
 {
     int oldEnvChoice = paramEnvParamsChosen[paramEnvNum]; //Get old value selected
     if(paramEnvParamsChosen[paramEnvNum] != (envChoice - 1))    //Checking if same as previously chosen param
@@ -299,64 +626,320 @@ void PostBoxSynth::updateParamEnvs(int paramEnvNum, int envChoice, float paramRe
     }
 }
     
-void PostBoxSynth::updateMaxParamVals(int paramEnvNum, float paramResult)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateMaxParamVals(int paramEnvNum, float paramResult)
 {
     if(!playing)    //If not playing then set max param to desired value
     {
-        maxParamsVals[paramEnvNum] -> init(paramResult, paramResult);
+        maxParamsVals[paramEnvNum].init(paramResult, paramResult);
     }
     
-    maxParamsVals[paramEnvNum] -> setTargetVal(paramResult);    //Otherwise set desired value as a target
+    maxParamsVals[paramEnvNum].setTargetVal(paramResult, paramRampSamples);    //Otherwise set desired value as a target
 }
 
-void PostBoxSynth::oscsNextSample(float* sample)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::oscsNextSample(float* sample)
+{
+    float xyEnvVals[2] = {envVals[1], envVals[2]}; //Getting the oscillator x y envolopes
+
+    if(numChannels == 1)    //Mono voices skip the panning
+    {
+        sample[0] = sourceOscs.getNextMonoVal(xyEnvVals);
+    }
+    else if(numChannels == 2)
+    {
+        sourceOscs.getNextVal(xyEnvVals, sample); //Get output of oscillators
+    }
+    else    //Surround voices spread each source over the speakers, the gains ramp towards the gains for the block
+    {
+        float sourceSamples[NumSources];
+        sourceOscs.getNextSourceVals(xyEnvVals, sourceSamples);
+        for(int s = 0; s < NumSources; ++s)
+        {
+            float* gains = panGains[s];
+            const float* steps = panGainSteps[s];
+            for(int c = 0; c < numChannels; ++c)
+            {
+                gains[c] += steps[c];
+                sample[c] += sourceSamples[s] * gains[c];
+            }
+        }
+    }
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::preparePanning(int numSamples)
+{
+    //Constant power gains are scaled to the power of a centred source in each channel of a stereo output
+    const float surroundLevel = 0.70710678f;
+    
+    for(int s = 0; s < NumSources; ++s)
+    {
+        float targetGains[maxChannels];
+        panner -> getSourceGains(s, sourceOscs.getPanAmount(s), targetGains);
+        
+        for(int c = 0; c < numChannels; ++c)
+        {
+            const float target = targetGains[c] * surroundLevel;
+            if(!panGainsSet)    //The first block of a note starts at its gains, the step lands on them at the first sample
+                panGains[s][c] = target;
+            panGainSteps[s][c] = panGainsSet ? (target - panGains[s][c]) / numSamples : 0.0f;
+        }
+    }
+    panGainsSet = true;
+}
+    
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::applyFX(int numSamples, bool useFilterBank)
 {
-    float envVals[2] = {myEnvs[1] -> getNextSample(), myEnvs[2] -> getNextSample()}; //Updating the oscillator x y envolopes
+    if(blockSilent)     //The LFO gain has no effect on silence, clear the block so the filters that still have a tail see no input
+    {
+        for(int i = 0; i < numChannels; ++i)
+            FloatVectorOperations::clear(voiceChannels[i], numSamples);
+    }
+    else
+    {
+        applyLFO(numSamples);   //Apply LFO
+       #if JUCE_DEBUG
+        denormalCounts[lfoDenormals] += countBlockDenormals(numSamples);
+       #endif
+        applyDrive(numSamples); //Drive the block into the filters
+    }
+    
+    //At lower quality a released voice that has gone quiet is left unfiltered
+    if(dropReleasedFilters && released && ampLevel < releasedFilterLevel)
+        return;
+    
+    if(!useFilterBank || !submitToFilterBank(numSamples))
+    {
+        applyFilter(numSamples);    //Apply filter if the filter bank is not filtering the block
+       #if JUCE_DEBUG
+        denormalCounts[filterDenormals] += countBlockDenormals(numSamples);
+       #endif
+    }
+}
 
-    sourceOscs.getNextVal(envVals, sample); //Get output of oscillators
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+bool PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::submitToFilterBank(int numSamples)
+{
+    if(filterBank == nullptr || numSamples == 0)
+        return false;
+    
+    int modes[NumFilters] = {};
+    float endCutoffs[NumFilters];
+    bool anyEnabled = false;
+    for(int i = 0; i < NumFilters; ++i)
+    {
+        endCutoffs[i] = filterCutoff[i];
+        if(filterEnable[i])
+        {
+            if(filterSVF[i] || filterFormant[i])    //The bank only has the butterworth filters, the voice runs the SVF and formant modes itself
+                return false;
+            
+            modes[i] = filterOrder[i];
+            anyEnabled = true;
+            
+            if(filterRamp[i])   //The bank interpolates to the cut off at the end of the block
+                endCutoffs[i] = filterCutoffBlock[i][numSamples - 1];
+        }
+    }
+    
+    if(!anyEnabled)
+        return false;
+    
+    //A silent block does not need filtering once the voices lanes have no tail left, lanes not used last
+    //block are cleared when the voice is next handed in so they have no tail to finish either
+    if(blockSilent && (!bankFilteredLastBlock || filterBank -> voiceSilent(voiceIndex, silenceLevel)))
+        return true;
+    
+    //The lanes may hold another filters old state if the voice was not using the bank last block
+    filterBank -> submitVoice(voiceIndex, voiceChannels, numSamples, modes, endCutoffs, !bankFilteredLastBlock);
+    bankFiltering = true;
+    blockSilent = false;
+    return true;
 }
     
-void PostBoxSynth::applyFX(float* sample)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::renderLFOs(int blockStart, int blockSamples)
+{
+    for(int i = 0; i < NumLFOs; ++i)
+    {
+        if(lfoGlobal[i])    //Global LFOs have already been rendered by the processor for the whole buffer
+        {
+            lfoVals[i] = globalLFOBuffer -> getReadPointer(i, blockStart);
+        }
+        else if(lfoActive(i))   //Otherwise render this voices LFO if it will be used
+        {
+            voiceLFOs[i].renderBlock(lfoBlock[i], blockSamples);
+            lfoVals[i] = lfoBlock[i];
+        }
+    }
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+bool PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::lfoActive(int lfoNum)
+{
+    //Depth of the first LFO can also be set by a parameter envolope
+    return lfoAmp[lfoNum] > 0.0001f || smoothLFOParams[lfoNum].checkChanging() || (lfoNum == 0 && envolopedParam[lfoParamDest]);
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::applyLFO(int numSamples)
 {
-    applyLFO(sample);   //Apply LFO
-    applyFilter(sample);    //Apply filter
+    for(int j = 0; j < NumLFOs; ++j)
+    {
+        if(lfoUsed[j])    //If lfo Amp not 0 in this block then enable it otherwise don't do calculations
+        {
+            float lfoGain[envBlockSize];
+            for(int i = 0; i < numSamples; ++i)     //Calculating the gain of each sample, the lfo value scaled by the depth plus the inverse depth
+                lfoGain[i] = lfoVals[j][i] * lfoAmpBlock[j][i] + (1.0f - lfoAmpBlock[j][i]);
+            
+            for(int i = 0; i < numChannels; ++i)  //For each channel apply the LFO gain to the block
+                FloatVectorOperations::multiply(voiceChannels[i], lfoGain, numSamples);
+        }
+    }
 }
     
-void PostBoxSynth::applyLFO(float* sample)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::prepareFilters()
 {
-    if(lfoAmp > 0.0001f)    //If lfo Amp not 0 then enable it otherwise don't do calculations
+    for(int i = 0; i < NumFilters; ++i)  //For each filter
     {
-        float lfoVal = lfoOsc.getNextSample() * lfoAmp; //get next lfo sample and apply lfo amp
-        float lfoDepthInv = 1.0f - lfoAmp;  //Inverse depth calcilation
+        //The cut off changes over the block if it is being smoothed or set by a parameter envolope
+        filterRamp[i] = filterEnable[i] && (smoothFilterParams[i].checkChanging() || envolopedParam[filterParamDest + i]);
         
-        for(int i = 0; i < 2; ++i)  //For each channel calculate the next sample with the LFO applied
-            sample[i] = (lfoVal + lfoDepthInv) * sample[i];
+        if(filterEnable[i] && !filterRamp[i])   //Otherwise the cut off is set once for the block
+        {
+            filterCutoff[i] = smoothFilterParams[i].getNextVal();
+            for(int p = 0; p < numChannelPairs; ++p)
+            {
+                if(filterSVF[i])
+                    pairFilters[p] -> svFilters[i].setFilterCutOffFreq(filterCutoff[i]);
+                else
+                    pairFilters[p] -> synthFilters[i].setFilterCutOffFreq(filterCutoff[i]);
+            }
+        }
     }
 }
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::prepareDrive()
+{
+    //The amount changes over the block if it is being smoothed or set by a parameter envolope
+    const bool driveOn = drive.getMode() != ADAADrive::off;
+    driveRamp = driveOn && (smoothDriveAmount.checkChanging() || envolopedParam[driveParamDest]);
+    
+    if(driveOn && !driveRamp)   //Otherwise the amount is set once for the block
+        driveAmount = smoothDriveAmount.getNextVal();
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::applyDrive(int numSamples)
+{
+    drive.process(voiceChannels, numSamples, driveRamp ? driveAmountBlock : nullptr, driveAmount);
     
-void PostBoxSynth::applyFilter(float* sample)
+    if(driveRamp && numSamples > 0) //Keep the last amount for when the amount stops changing
+        driveAmount = driveAmountBlock[numSamples - 1];
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::applyFilter(int numSamples)
 {
-    for(int i = 0; i < 2; ++i)  //For each filter
+    for(int i = 0; i < NumFilters; ++i)  //For each filter
     {
         if(filterEnable[i]) //Check filter is enabled
         {
-            synthFilters[i] -> setFilterCutOffFreq(getParamVal(10 + i, smoothFilterParams[i] -> getNextVal())); //Set cutoff frequency for the filter
-            synthFilters[i] -> getNextSample(sample);   //Get updated samples when processed through the filter
+            if(blockSilent && filterSilent(i))  //Skip the filter if nothing is going in and its tail has died away
+            {
+                if(filterRamp[i])   //Keep the cut off moving so the filter wakes up at the right cut off
+                {
+                    for(int p = 0; p < numChannelPairs; ++p)
+                    {
+                        if(filterSVF[i])
+                            pairFilters[p] -> svFilters[i].setFilterCutOffFreq(filterCutoffBlock[i][numSamples - 1]);
+                        else
+                            pairFilters[p] -> synthFilters[i].setFilterCutOffFreq(filterCutoffBlock[i][numSamples - 1]);
+                    }
+                }
+                continue;
+            }
+            
+            //Filter the block a pair of channels at a time with the cut offs for each sample if changing, the formants
+            //move to the vowel of the X and Y envolopes at the end of the block
+            const float* cutoffRamp = filterRamp[i] ? filterCutoffBlock[i] : nullptr;
+            for(int p = 0; p < numChannelPairs; ++p)
+            {
+                float* const* pairChannels = voiceChannels + 2 * p;
+                PairFilters& filters = *pairFilters[p];
+                if(filterFormant[i])
+                {
+                    const float* endEnvVals = envBlock + (numSamples - 1) * EnvelopeBank::numLanes;
+                    filters.formantFilters[i].setVowel(endEnvVals[1], endEnvVals[2]);
+                    filters.formantFilters[i].process(pairChannels, numSamples);
+                }
+                else if(filterSVF[i])
+                    filters.svFilters[i].process(pairChannels, numSamples, cutoffRamp);
+                else
+                    filters.synthFilters[i].process(pairChannels, numSamples, cutoffRamp);
+            }
+            
+            blockSilent = false;    //The filters tail is in the block now
         }
     }
 }
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+bool PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::checkBlockSilent(int numSamples) const
+{
+    if(numSamples == 0)
+        return false;
     
-void PostBoxSynth::resetVoice()
+    for(int i = 0; i < numChannels; ++i)
+    {
+        auto range = FloatVectorOperations::findMinAndMax(voiceChannels[i], numSamples);
+        if(range.getStart() <= -silenceLevel || range.getEnd() >= silenceLevel)
+            return false;
+    }
+    return true;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+int PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::countBlockDenormals(int numSamples) const
+{
+    int count = 0;
+    for(int i = 0; i < numChannels; ++i)
+        count += Denormals::count(voiceChannels[i], numSamples);
+    return count;
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+bool PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::filterSilent(int filterNum) const
+{
+    for(int p = 0; p < numChannelPairs; ++p)    //Every pair of channels has to have died away
+    {
+        if(filterFormant[filterNum] ? !pairFilters[p] -> formantFilters[filterNum].isSilent(silenceLevel)
+           : filterSVF[filterNum] ? !pairFilters[p] -> svFilters[filterNum].isSilent(silenceLevel)
+           : !pairFilters[p] -> synthFilters[filterNum].isSilent(silenceLevel))
+            return false;
+    }
+    return true;
+}
+    
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::resetVoice()
 {
     clearCurrentNote(); //Clear Current Note
     playing = false;    //Mark stopped playing note
     released = false;   //Release note
-    updateParams();     //Update parameters to targets
+    ampLevel = 0.0f;
+    updateParams(1);    //Update parameters to targets
+    updateEnvParams(1);    //Update envolope parameters to targets
     sourceOscs.playMode(false); //Set source oscs to not playing
 }
     
     
-void PostBoxSynth::setADSR(int envNum, float adsrVals[4])
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setADSR(int envNum, float adsrVals[4])
 {
     //Setting ADSR parameters
     ADSR::Parameters myADSR;
@@ -371,27 +954,30 @@ void PostBoxSynth::setADSR(int envNum, float adsrVals[4])
         
 }
     
-void PostBoxSynth::setADSR(int envNum, ADSR::Parameters adsrParams)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::setADSR(int envNum, ADSR::Parameters adsrParams)
 {
-    myEnvs[envNum] -> setParameters(adsrParams);   //Setting envolope with passed parameters
+    envBank.setParameters(envNum, adsrParams);   //Setting envolope with passed parameters
 }
     
     
 
     
-void PostBoxSynth::getNextParamEnvVals()
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::getNextParamEnvVals()
 {
-    std::vector<int> alreadyPickedVals;         //Vector to store already picked vals
+    std::array<int, numParamEnvs> alreadyPickedVals;    //Array to store already picked vals, one at most for each envolope
+    int numPicked = 0;
     
-    for(int i = 0; i < myEnvs.size()-3; ++i)    //Iterate through param envolopes
+    for(int i = 0; i < numParamEnvs; ++i)    //Iterate through param envolopes
     {
         if( paramEnvParamsChosen[i] > -1)       //If param envolope active
         {
             int chosenParam = paramEnvParamsChosen[i];  //Get chosen parameter of envolope
             bool valAlreadyChosen = false;
-            for( int val : alreadyPickedVals)           //Check if value already chosen
+            for(int j = 0; j < numPicked; ++j)           //Check if value already chosen
             {
-                if(val == chosenParam)
+                if(alreadyPickedVals[j] == chosenParam)
                 {
                     valAlreadyChosen = true;
                     break;
@@ -399,12 +985,12 @@ void PostBoxSynth::getNextParamEnvVals()
             }
             if(valAlreadyChosen)    //If value already choesen then multiply by previous value
             {
-                envolopedParamVals[chosenParam] = envolopedParamVals[chosenParam] * myEnvs[i+3] -> getNextSample();
+                envolopedParamVals[chosenParam] = envolopedParamVals[chosenParam] * envVals[i+3];
             }
             else            //Otherwise reset envoloped param num
             {
-                envolopedParamVals[chosenParam] = myEnvs[i+3] -> getNextSample();
-                alreadyPickedVals.push_back(chosenParam);   //Add parameter to already picked vector
+                envolopedParamVals[chosenParam] = envVals[i+3];
+                alreadyPickedVals[numPicked++] = chosenParam;   //Add parameter to already picked array
             }
         }
         
@@ -413,75 +999,413 @@ void PostBoxSynth::getNextParamEnvVals()
         
 }
     
-float PostBoxSynth::getParamVal(int paramNum, float paramVal)
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+float PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::getParamVal(int paramNum, float paramVal)
 {
     if(envolopedParam[paramNum])    //If parameter to be envoloped return envoloped result
     {
-        return (paramVal + (maxParamsVals[paramNum] -> getNextVal() - paramVal) * envolopedParamVals[paramNum]);
+        return (paramVal + (maxParamsVals[paramNum].getNextVal() - paramVal) * envolopedParamVals[paramNum]);
     }
         
     return paramVal;    //Otherwise return entered parameter value
 }
 
     
-void PostBoxSynth::updateParams()
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateParams(int numSamples)
 {
     getNextParamEnvVals(); //Get next parameter envolope values
-    updateOscParams();      //Update oscillator parameters
-    updateLFOParams();      //Update LFO parameters
-    updateEnvParams();      //Update envolope parameters
+    updateOscParams(numSamples);    //Update oscillator parameters
+    updateLFOParams(numSamples);    //Update LFO parameters
+}
+
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::skipParamVal(int paramNum, int numSamples)
+{
+    if(envolopedParam[paramNum])
+        maxParamsVals[paramNum].skip(numSamples);
 }
 
-void PostBoxSynth::updateEnvParams()
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateEnvParams(int numSamples)
 {
-    for(int i = 0; i < myEnvs.size(); ++i)
+    for(int i = 0; i < NumEnvs; ++i)
     {
-        if(smoothEnvParams[i] -> checkChanging())   //Check if parameters are changing
+        if(smoothEnvParams[i].checkChanging())   //Check if parameters are changing
         {
             float adsrVals[4] = {0.0f, 0.0f, 0.0f, 0.0f};
             if(!playing)     //If not playing then update envolope parameters to target
             {
-                smoothEnvParams[i] -> setToTarget();
+                smoothEnvParams[i].setToTarget();
             }
                 
-            smoothEnvParams[i] -> getNextVal(adsrVals); //Get next smoothed value
+            smoothEnvParams[i].getNextVal(adsrVals); //Get next smoothed value and skip over the rest of the block
+            smoothEnvParams[i].skip(numSamples - 1);
 
-            setADSR(i, adsrVals);   //Set envolope ADSR with update values
+            setADSR(i, adsrVals);   //Set envolope ADSR with update values, applied by the envolopes at the start of the block
         }
 
     }
 }
     
-void PostBoxSynth::updateOscParams()
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateOscParams(int numSamples)
 {
-    for(int i = 0; i < 4; ++i)  //iterate through all oscillators
+    for(int i = 0; i < NumSources; ++i)  //iterate through all oscillators
     {
         float osc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
         if(!playing)                        //If not playing then set smoother to target
         {
-            smoothOscParams[i] -> setToTarget();
+            smoothOscParams[i].setToTarget();
         }
-        smoothOscParams[i] -> getNextVal(osc);              //Get next smoothed params
+        smoothOscParams[i].getNextVal(osc);              //Get next smoothed params
         
         //Update source oscillator parameters
         sourceOscs.setOscMinMaxVolume(i, osc[2], osc[3]);
-        sourceOscs.setPanAmount(i, getParamVal(2 * i + 1, osc[1]));
-        sourceOscs.setTuneAmount(i, getParamVal(2 * i, osc[0]));
+        sourceOscs.setPanAmount(i, getParamVal(oscParamDest + 2 * i + 1, osc[1]));
+        sourceOscs.setTuneAmount(i, getParamVal(oscParamDest + 2 * i, osc[0]));
+        
+        //Skipping the smoothers over the samples until the next update
+        smoothOscParams[i].skip(numSamples - 1);
+        skipParamVal(oscParamDest + 2 * i, numSamples - 1);
+        skipParamVal(oscParamDest + 2 * i + 1, numSamples - 1);
     }
 }
     
     
-void PostBoxSynth::updateLFOParams()
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+void PostBoxSynthVoice<NumSources, NumEnvs, NumFilters, NumLFOs>::updateLFOParams(int numSamples)
+{
+    for(int i = 0; i < NumLFOs; ++i)
+    {
+        float lfoParams[2] = {0,0};
+        if(!playing)                    //If not playing then set LFO params to target
+        {
+            smoothLFOParams[i].setToTarget();
+        }
+        smoothLFOParams[i].getNextVal(lfoParams);    //Get next LFO parameter values
+        
+        if(i == 0)  //Only the first LFO can be changed by the parameter envolopes
+        {
+            lfoParams[1] = getParamVal(lfoParamDest + 1, lfoParams[1]);
+            lfoParams[0] = getParamVal(lfoParamDest, lfoParams[0]);
+            skipParamVal(lfoParamDest, numSamples - 1);
+            skipParamVal(lfoParamDest + 1, numSamples - 1);
+        }
+        smoothLFOParams[i].skip(numSamples - 1);
+            
+        voiceLFOs[i].setFrequency(lfoParams[1]);  //Set lfo Frequency, used from the next LFO block
+            
+        lfoAmp[i] = lfoParams[0];  //Get LFO amplitude
+    }
+}
+  
+
+//The voice the synth plays, every other topology is only compiled if it is used
+template class PostBoxSynthVoice<4, 8, 2, 2>;
+
+//==============================================================================
+
+//Defined here as the polyphony parameter passes it by reference through std::make_unique
+constexpr int PostBoxSynthesiser::maxVoices;
+
+PostBoxSynthesiser::PostBoxSynthesiser()
+{
+    for(int i = 0; i < 128; ++i)
+        noteVoices[i] = -1;
+}
+
+void PostBoxSynthesiser::setParamSources(OwnedArray<EnvolopeParams>* envs, OwnedArray<SimpleParams>* oscs, OwnedArray<SimpleParams>* lfos, OwnedArray<SimpleParams>* filters, SimpleParams* drive, OwnedArray<SimpleParams>* paramEnvsChoice)
+{
+    envParams = envs;
+    oscParams = oscs;
+    lfoParams = lfos;
+    filterParams = filters;
+    driveParams = drive;
+    paramEnvParams = paramEnvsChoice;
+}
+
+void PostBoxSynthesiser::prepareVoices(float sampleRate, const AudioBuffer<float>* globalLFOBuffer, const AudioChannelSet& outputLayout)
 {
-    float lfoParams[2] = {0,0};
-    if(!playing)                    //If not playing then set LFO params to target
+    const int numVoices = getNumVoices();
+    const int numOutputChannels = jlimit(1, PostBoxSynth::maxChannels, outputLayout.size());
+    
+    //Voices render in mono for a mono output, stereo for a stereo output and a channel for each speaker of a surround output
+    panner.setLayout(outputLayout);
+    const int numChannels = numOutputChannels <= 2 ? numOutputChannels : jmax(1, panner.getNumSpeakers());
+    
+    //Casting the voices once so the audio thread never has to
+    voicePool.clearQuick();
+    for(int i = 0; i < numVoices; ++i)
     {
-        smoothLFOParams[0] -> setToTarget();
+        PostBoxSynth* v = dynamic_cast<PostBoxSynth*>(getVoice(i));
+        jassert(v != nullptr);  //Only PostBoxSynth voices can be added
+        voicePool.add(v);
     }
-    smoothLFOParams[0] -> getNextVal(lfoParams);    //Get next LFO parameter values
+    
+    freeVoices.calloc(numVoices);
+    activeVoices.calloc(numVoices);
+    activePositions.calloc(numVoices);
+    voiceParamVersions.calloc(numVoices);
+    
+    //Every voice starts free, stacked so the lowest voices are used first which keeps the
+    //playing voices together in the filter bank
+    numActive = 0;
+    numFree = numVoices;
+    for(int i = 0; i < numVoices; ++i)
+        freeVoices[i] = numVoices - 1 - i;
+    for(int i = 0; i < 128; ++i)
+        noteVoices[i] = -1;
+    
+    filterBank.prepare(sampleRate, numVoices, numChannels);
+    
+    //Joining the workers shared by every instance, with one core every voice is rendered on the audio thread
+    if(renderPool == nullptr && VoiceRenderPool::getDefaultNumWorkers() > 0)
+        renderPool = VoiceRenderPool::getSharedPool();
+    
+    //A buffer for every group of voices that can be rendered by a job
+    const int numGroups = (numVoices + voicesPerJob - 1) / voicesPerJob;
+    groupBuffers.clear();
+    for(int g = 0; g < numGroups; ++g)
+        groupBuffers.add(new AudioBuffer<float>(numOutputChannels, PostBoxSynth::envBlockSize));
+    groupPlaying.calloc(numGroups);
+    
+    for(int i = 0; i < numVoices; ++i)  //Initalising every voice in the pool
+    {
+        PostBoxSynth* v = voicePool[i];
+        v -> setFilterBank(&filterBank, i);
+        v -> setSampleRate(sampleRate);
+        v -> setNumChannels(numChannels, &panner);
+        v -> setGlobalLFOBuffer(globalLFOBuffer);
+        v -> stopNote(0.0f, false);
+        syncVoice(i);
+    }
+}
+
+void PostBoxSynthesiser::updateVoiceParams(int rampSamples)
+{
+    ++paramVersion; //Voices that are not playing catch up when they are next started
+    
+    for(int a = 0; a < numActive; ++a)
+    {
+        const int voiceNum = activeVoices[a];
+        if(envParams != nullptr)
+            voicePool[voiceNum] -> setParams(*envParams, *oscParams, *lfoParams, *filterParams, *driveParams, *paramEnvParams, rampSamples);
+        voiceParamVersions[voiceNum] = paramVersion;
+    }
+}
+
+void PostBoxSynthesiser::setEnvCurve(float newCurve)
+{
+    envCurve = newCurve;
+    
+    for(int a = 0; a < numActive; ++a)
+        voicePool[activeVoices[a]] -> setEnvCurve(envCurve);
+}
+
+void PostBoxSynthesiser::setRenderQuality(int controlInterval, bool dropReleasedFilters)
+{
+    //Setting every voice so the free ones start at the same quality
+    for(auto* v : voicePool)
+        v -> setRenderQuality(controlInterval, dropReleasedFilters);
+}
+
+void PostBoxSynthesiser::setPolyphony(int newPolyphony)
+{
+    polyphony = jlimit(1, maxVoices, newPolyphony);
+}
+
+PostBoxSynth* PostBoxSynthesiser::getPoolVoice(int index) const
+{
+    return voicePool[index];
+}
+
+bool PostBoxSynthesiser::globalLFOInUse(int lfoNum) const
+{
+    for(int a = 0; a < numActive; ++a)
+    {
+        if(voicePool[activeVoices[a]] -> usesGlobalLFO(lfoNum))
+            return true;
+    }
+    return false;
+}
+
+void PostBoxSynthesiser::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    const ScopedLock sl(lock);
+    
+    if(midiNoteNumber < 0 || midiNoteNumber > 127)
+        return;
+    
+    for(auto* sound : sounds)
+    {
+        if(sound -> appliesToNote(midiNoteNumber) && sound -> appliesToChannel(midiChannel))
+        {
+            //If the note is still ringing, stop it first, only the last voice started on a note can still be holding it
+            const int lastVoice = noteVoices[midiNoteNumber];
+            if(lastVoice >= 0 && voicePool[lastVoice] -> getCurrentlyPlayingNote() == midiNoteNumber && voicePool[lastVoice] -> isPlayingChannel(midiChannel))
+                stopVoice(voicePool[lastVoice], 1.0f, true);
+            
+            const int voiceNum = allocateVoice();
+            if(voiceNum < 0)    //No free voices and stealing is off
+                return;
+            
+            syncVoice(voiceNum);
+            startVoice(voicePool[voiceNum], sound, midiChannel, midiNoteNumber, velocity);
+            noteVoices[midiNoteNumber] = voiceNum;
+        }
+    }
+}
+
+int PostBoxSynthesiser::allocateVoice()
+{
+    if(numActive < polyphony && numFree > 0)    //Take the voice from the top of the free list
+    {
+        const int voiceNum = freeVoices[--numFree];
+        activePositions[voiceNum] = numActive;
+        activeVoices[numActive++] = voiceNum;
+        return voiceNum;
+    }
+    
+    if(!isNoteStealingEnabled() || numActive == 0)
+        return -1;
+    
+    //Steal the quietest voice, it stays in the active list for its new note
+    int quietest = activeVoices[0];
+    for(int a = 1; a < numActive; ++a)
+    {
+        if(voicePool[activeVoices[a]] -> getAmpLevel() < voicePool[quietest] -> getAmpLevel())
+            quietest = activeVoices[a];
+    }
+    return quietest;
+}
+
+void PostBoxSynthesiser::freeVoice(int voiceNum)
+{
+    //Moving the last active voice into the freed position
+    const int position = activePositions[voiceNum];
+    const int lastVoice = activeVoices[--numActive];
+    activeVoices[position] = lastVoice;
+    activePositions[lastVoice] = position;
+    
+    freeVoices[numFree++] = voiceNum;
+}
+
+void PostBoxSynthesiser::releaseFinishedVoices()
+{
+    for(int a = numActive - 1; a >= 0; --a)
+    {
+        const int voiceNum = activeVoices[a];
+        if(!voicePool[voiceNum] -> isVoiceActive())
+            freeVoice(voiceNum);
+    }
+}
+
+void PostBoxSynthesiser::syncVoice(int voiceNum)
+{
+    PostBoxSynth* v = voicePool[voiceNum];
+    
+    if(voiceParamVersions[voiceNum] != paramVersion && envParams != nullptr)  //Passing on every parameter change the voice missed while it was free
+    {
+        v -> resetParamSwitches();
+        v -> setParams(*envParams, *oscParams, *lfoParams, *filterParams, *driveParams, *paramEnvParams, 0);
+    }
+    voiceParamVersions[voiceNum] = paramVersion;
+    
+    v -> setEnvCurve(envCurve);
+}
+
+void PostBoxSynthesiser::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    const int endSample = startSample + numSamples;
+    
+    for(int blockStart = startSample; blockStart < endSample; blockStart += PostBoxSynth::envBlockSize)
+    {
+        const int blockSamples = jmin(PostBoxSynth::envBlockSize, endSample - blockStart);
+        
+        //With enough voices playing the block is rendered on the workers, voices only start bettween
+        //calls so if none are playing none will be for the rest of the call
+        if(renderPool != nullptr && numActive >= parallelVoiceThreshold && blockSamples >= parallelBlockThreshold)
+        {
+            const bool anyPlaying = renderBlockParallel(outputAudio, blockStart, blockSamples);
+            releaseFinishedVoices();
+            if(!anyPlaying)
+                return;
+            continue;
+        }
+        
+        //Every active voice renders its block up to the filters, the free voices cost nothing
+        bool anyPlaying = false;
+        for(int a = 0; a < numActive; ++a)
+            anyPlaying = voicePool[activeVoices[a]] -> renderVoiceBlock(blockStart, blockSamples, true) > 0 || anyPlaying;
+        
+        //Voices only start bettween calls so if none are playing none will be for the rest of the call
+        if(!anyPlaying)
+        {
+            releaseFinishedVoices();
+            return;
+        }
         
-    lfoOsc.setFrequency(getParamVal(9, lfoParams[1]));  //Set lfo Frequency
+        //Filtering all the voices handed to the bank together then finishing every voice
+        filterBank.process(blockSamples);
+        for(int a = 0; a < numActive; ++a)
+            voicePool[activeVoices[a]] -> finishVoiceBlock(outputAudio, blockStart);
         
-    lfoAmp = getParamVal(8, lfoParams[0]);  //Get LFO amplitude
+        //Voices that finished this block go back on the free list
+        releaseFinishedVoices();
+    }
+}
+
+bool PostBoxSynthesiser::renderBlockParallel(AudioBuffer<float>& outputAudio, int blockStart, int blockSamples)
+{
+    const int numJobs = (numActive + voicesPerJob - 1) / voicesPerJob;
+    jobBlockStart = blockStart;
+    jobBlockSamples = blockSamples;
+    
+    //Every group renders its voices up to the filters
+    jobStage = renderStage;
+    renderPool -> run(*this, numJobs, renderDeadline);
+    
+    bool anyPlaying = false;
+    for(int j = 0; j < numJobs; ++j)
+        anyPlaying = anyPlaying || groupPlaying[j];
+    
+    if(!anyPlaying)
+        return false;
+    
+    //The filter bank runs on this thread bettween the two stages, then every group finishes its voices into its own buffer
+    filterBank.process(blockSamples);
+    jobStage = finishStage;
+    renderPool -> run(*this, numJobs, renderDeadline);
+    
+    //Adding the groups in a fixed order so the result does not depend on which thread finished first
+    const int numChannels = jmin(outputAudio.getNumChannels(), groupBuffers[0] -> getNumChannels());    //The group buffers have the layout of the output
+    for(int j = 0; j < numJobs; ++j)
+    {
+        for(int chan = 0; chan < numChannels; ++chan)
+            outputAudio.addFrom(chan, blockStart, *groupBuffers[j], chan, 0, blockSamples);
+    }
+    
+    return true;
+}
+
+void PostBoxSynthesiser::runJob(int jobIndex)
+{
+    const int firstActive = jobIndex * voicesPerJob;
+    const int endActive = jmin(firstActive + voicesPerJob, numActive);
+    
+    if(jobStage == renderStage)
+    {
+        bool playing = false;
+        for(int a = firstActive; a < endActive; ++a)
+            playing = voicePool[activeVoices[a]] -> renderVoiceBlock(jobBlockStart, jobBlockSamples, true) > 0 || playing;
+        groupPlaying[jobIndex] = playing;
+    }
+    else
+    {
+        AudioBuffer<float>& groupBuffer = *groupBuffers[jobIndex];
+        groupBuffer.clear();
+        for(int a = firstActive; a < endActive; ++a)
+            voicePool[activeVoices[a]] -> finishVoiceBlock(groupBuffer, 0);
+    }
 }
-  
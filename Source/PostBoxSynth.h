@@ -17,6 +17,16 @@
 #include "ParamStore.h"
 #include "XYEnvolopedOscs.h"
 #include "MyIIRFilter.h"
+#include "StateVariableFilter.h"
+#include "FormantFilter.h"
+#include "DriveStage.h"
+#include "VoiceFilterBank.h"
+#include "VoiceRenderPool.h"
+#include "VoiceArena.h"
+#include "SurroundPanner.h"
+#include "EnvelopeBank.h"
+#include "SynthLFO.h"
+#include <array>     //Including array for the fixed size parts of the voice
 
 // ===========================
 // ===========================
@@ -37,23 +47,66 @@ public:
 // Synthesiser Voice
 
 /*!
- @class PostBoxSynth
+ @class PostBoxSynthVoice
  @abstract the processing for each synth voice.
- @discussion multiple PostBoxSynth objects will be created by the Synthesiser so that it can be played polyphicially
+ @discussion multiple voices will be created by the Synthesiser so that it can be played polyphicially.
+             The number of sources, envolopes, filters and LFOs are template parameters so every
+             part of the voice is held in fixed size arrays inside the voice, the loops over them
+             have trip counts known when compiling and a count that does not match the parameters
+             or the rest of the synth fails to compile. The synth uses the PostBoxSynth topology.
+             The state the voice touches every sample is declared first and the settings only read
+             when parameters change after it, on their own cache line, so rendering a voice only
+             loads the hot half. Voices are built in the processors VoiceArena so the whole pool
+             sits in one block of memory. On a mono output the voice renders one channel, the
+             sources are summed without panning and the butterworth filters and drive only run once.
+             On a surround output the voice renders a channel for each speaker, each source is
+             spread over the speakers with gains from the synths SurroundPanner that are looked up
+             once a block and ramped across it, and the filters run on the channels a pair at a time
  
  @namespace none
- @updated 2020-04-24
+ @updated 2026-10-19
  */
-class PostBoxSynth : public SynthesiserVoice
+template <int NumSources, int NumEnvs, int NumFilters, int NumLFOs>
+class PostBoxSynthVoice : public SynthesiserVoice
 {
+    static_assert(NumSources == 4, "The X and Y envolopes mix a 2 by 2 square of sources");
+    static_assert(NumEnvs > 3 && NumEnvs <= EnvelopeBank::numLanes, "Amp, X and Y envolopes and the parameter envolopes must fit in the envolope bank");
+    static_assert(NumFilters == VoiceFilterBank::numFilters, "The filter bank holds a low pass and a high pass filter for each voice");
+    static_assert(NumLFOs >= 1, "The first LFO is the one the parameter envolopes can change");
+    static_assert(NumSources == SurroundPanner::maxSources, "Every source needs a surround depth");
+    
 public:
     //==============================================================================
     /** Constructor*/
-    PostBoxSynth(int numOscs, int numEnvs, int numFilters);
+    PostBoxSynthVoice();
     /** Destructors*/
-    ~PostBoxSynth(){};
+    ~PostBoxSynthVoice()
+    {
+        if(surround != nullptr)     //The arena only frees the memory
+            surround -> ~SurroundChannels();
+    }
     //==============================================================================
     
+    //Voices are only built in a VoiceArena, deleting one runs its destructor and the arena frees the memory
+    static void* operator new(size_t size, VoiceArena& arena) { return arena.allocate(size); }
+    static void operator delete(void*, VoiceArena&) {}
+    static void operator delete(void*) {}
+    
+    //Topology of the voice, the envolopes after amp, X and Y are parameter envolopes
+    static constexpr int numSources = NumSources;
+    static constexpr int numEnvs = NumEnvs;
+    static constexpr int numFilters = NumFilters;
+    static constexpr int numLFOs = NumLFOs;
+    static constexpr int numParamEnvs = NumEnvs - 3;
+    
+    //First parameter of each group the parameter envolopes can change, tune and pan of each source,
+    //depth and frequency of the first LFO, the cut off of each filter and the drive amount
+    static constexpr int oscParamDest = 0;
+    static constexpr int lfoParamDest = 2 * NumSources;
+    static constexpr int filterParamDest = lfoParamDest + 2;
+    static constexpr int driveParamDest = filterParamDest + NumFilters;
+    static constexpr int numEnvolopedParams = driveParamDest + 1;
+    
     /**
      * Sets the sample Rate of the oscillator
      *
@@ -69,10 +122,12 @@ public:
      * @param oscs is an array of oscillator parameters
      * @param lfos is an array of lfoparameters
      * @param filters is an array of filter parameters
-     * @param filters is an array of filter parameters
+     * @param drive is the drive mode and amount
      * @param costmEnvsChoice  is an array of parameter envolope parameters
+     * @param rampSamples is the number of samples to ramp changed parameters over while playing,
+     *                    0 uses the normal smoothing time
     */
-    void setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<SimpleParams>& oscs, OwnedArray<SimpleParams>& lfos, OwnedArray<SimpleParams>& filters, OwnedArray<SimpleParams>& paramEnvsChoice);
+    void setParams(OwnedArray<EnvolopeParams>& envs, OwnedArray<SimpleParams>& oscs, OwnedArray<SimpleParams>& lfos, OwnedArray<SimpleParams>& filters, SimpleParams& drive, OwnedArray<SimpleParams>& paramEnvsChoice, int rampSamples);
     
      /**
       * What should be done when a note starts
@@ -103,6 +158,28 @@ public:
      */
     void renderNextBlock(AudioSampleBuffer& outputBuffer, int startSample, int numSamples) override;
     //--------------------------------------------------------------------------
+    /**
+     * Renders one block of the voice up to the filters, the filtering is done by the voice
+     * or, if it can, handed to the filter bank to be filtered with the other voices
+     *
+     * @param blockStart is the position in the output buffer of the start of the block
+     * @param blockSamples is the number of samples in the block, at most envBlockSize
+     * @param useFilterBank true if the filter bank is processed bettween this and finishVoiceBlock
+     *
+     * @return the number of samples played, 0 if the voice is not playing
+     *
+    */
+    int renderVoiceBlock(int blockStart, int blockSamples, bool useFilterBank);
+    //--------------------------------------------------------------------------
+    /**
+     * Applies the amp envolope to the last rendered block and adds it to the output
+     *
+     * @param outputBuffer is the buffer to add the voice to
+     * @param blockStart is the position in the output buffer of the start of the block
+     *
+    */
+    void finishVoiceBlock(AudioSampleBuffer& outputBuffer, int blockStart);
+    //--------------------------------------------------------------------------
     /**
      * Listener for the pitch wheel moving
      *
@@ -129,27 +206,169 @@ public:
      */
     bool canPlaySound (SynthesiserSound* sound) override;
     
+    /**
+     * Sets the curve of all the envolopes
+     *
+     * @param newCurve is the curve from 0 -> 1, 0 gives linear segments
+     *                 and 1 gives analog style exponential segments
+     *
+    */
+    void setEnvCurve(float newCurve);
+    
+    /**
+     * Sets the buffer of LFOs rendered once per block by the processor for LFOs in global mode
+     *
+     * @param newGlobalLFOBuffer is a buffer with one channel per LFO
+     *
+    */
+    void setGlobalLFOBuffer(const AudioBuffer<float>* newGlobalLFOBuffer);
+    
+    /**
+     * Sets the filter bank shared by all the voices
+     *
+     * @param newFilterBank is the filter bank
+     * @param newVoiceIndex is the index of this voice in the filter bank
+     *
+    */
+    void setFilterBank(VoiceFilterBank* newFilterBank, int newVoiceIndex);
+    
+    /**
+     * Gets the level of the amp envolope at the end of the last rendered block, a voice that
+     * has started but not rendered yet counts as full level so it is not stolen straight away
+     *
+     * @return the amp envolope level from 0 -> 1
+     *
+    */
+    float getAmpLevel() const { return ampLevel; }
+    
+    /**
+     * Checks if the voice is reading a global LFO, a voice keeps reading it while its smoothed depth
+     * falls to 0 after the depth parameter has been set to 0
+     *
+     * @param lfoNum is the LFO to check
+     *
+     * @return true if the LFO is in global mode and its depth is not 0 or could be changed by a smoother or parameter envolope
+     *
+    */
+    bool usesGlobalLFO(int lfoNum) { return lfoGlobal[lfoNum] && lfoActive(lfoNum); }
+    
+    /**
+     * Marks every parameter as changed so the next call to setParams updates all of them,
+     * used for voices that have been idle while the parameters were not being passed to them
+     *
+    */
+    void resetParamSwitches();
+    
+    /**
+     * Sets how much detail the voice renders with, lowered when the processor is running out of time
+     *
+     * @param newControlInterval is the number of samples bettween parameter updates, 1 updates every sample,
+     *                           must divide envBlockSize
+     * @param newDropReleasedFilters is true to stop filtering the voice once it is released and quieter than releasedFilterLevel
+     *
+    */
+    void setRenderQuality(int newControlInterval, bool newDropReleasedFilters);
+    
+    /**
+     * Sets the number of channels the voice renders, a mono voice does not pan its sources and
+     * only filters and drives the left channel, not for the audio thread
+     *
+     * @param newNumChannels is 1 for mono, 2 for stereo or the number of speakers of a surround output
+     * @param newPanner is the panner the sources are spread over the speakers by, only used above 2 channels
+     *
+    */
+    void setNumChannels(int newNumChannels, const SurroundPanner* newPanner);
+    
+    //Number of samples in each envolope and LFO block, envolope parameters are updated once per block
+    static constexpr int envBlockSize = 32;
+    
+    //Most channels the voice renders and the pairs of channels the filters run on
+    static constexpr int maxChannels = SurroundPanner::maxChannels;
+    static constexpr int maxChannelPairs = maxChannels / 2;
+    
+    //Level below which a block or a filter state is treated as silent, -120dB
+    static constexpr float silenceLevel = 0.000001f;
+    
+    //Amp level below which a released voice can stop being filtered at a lower quality, -40dB
+    static constexpr float releasedFilterLevel = 0.01f;
+    
+    //Stages of the voice that denormal results are counted after in debug builds
+    enum DenormalStage
+    {
+        oscDenormals = 0,
+        envDenormals,
+        lfoDenormals,
+        filterDenormals,
+        numDenormalStages
+    };
+    
+    /**
+     * Gets the number of denormal results a stage has produced since the counts were reset,
+     * only counted in debug builds
+     *
+     * @param stage is one of the values in DenormalStage
+     *
+     * @return the number of denormal results
+     *
+    */
+    int getDenormalCount(int stage) const;
+    
+    /**
+     * Resets the denormal counts of every stage
+     *
+    */
+    void resetDenormalCounts();
     
 private:
     
+    //Filters of one pair of channels for each filter, the butterworth filters, the state variable filters used by the SVF modes
+    //and the formant filters used by the formant mode
+    struct PairFilters
+    {
+        std::array<StereoIIRFilters, NumFilters> synthFilters;
+        std::array<ZDFStateVariableFilter, NumFilters> svFilters;
+        std::array<FormantFilter, NumFilters> formantFilters;
+    };
+    
+    //Channels of the block and filters of the pairs after the first, mono and stereo voices never need them so
+    //they are kept out of the voice
+    struct SurroundChannels
+    {
+        alignas(64) float voiceBlock[maxChannels - 2][envBlockSize] = {};
+        std::array<PairFilters, maxChannelPairs - 1> pairFilters;
+    };
+    
     /**
      * Updates the filter parameters
      *
      * @param filterNum is which filter to update
      * @param filterMode is the mode of the filter
      * @param filterFreq is cutoff frequency of the filter in Hz
+     * @param filterRes is the resonance of the state variable filter and formant modes from 0 -> 1
      *
     */
-    void updateFilters(int filterNum, int filterMode, float filterFreq);
+    void updateFilters(int filterNum, int filterMode, float filterFreq, float filterRes);
+    
+    /**
+     * Updates the drive parameters
+     *
+     * @param driveMode is the curve of the drive, one of the values in ADAADrive::DriveMode
+     * @param driveAmount is the drive amount from 0 -> 1
+     *
+    */
+    void updateDrive(int driveMode, float driveAmount);
     
     /**
      * Updates the LFO parameters
      *
+     * @param lfoNum is which LFO to update
      * @param lfpAmp is the updated lfo amplitude parameter
      * @param lfoFreq is lfo frequency in Hz
+     * @param lfoShape is the shape of the lfo
+     * @param lfoMode is 0 for an LFO owned by this voice, 1 for a global LFO shared by all voices
      *
     */
-    void updateLFOs(float lfoAmp, float lfoFreq);
+    void updateLFOs(int lfoNum, float lfoAmp, float lfoFreq, int lfoShape, int lfoMode);
     
     /**
      * Updates the envolope parameters
@@ -194,34 +413,122 @@ private:
     /**
      * Gets next samples from the oscilllators
      *
-     * @param sample returns an array of ocillator next samples
+     * @param sample returns an array of ocillator next samples, the right sample is 0 for a mono voice
      *
     */
     void oscsNextSample(float* sample);
     
     /**
-     * Applies FX to stereo samples
+     * Looks up the speaker gains of each source for the block and works out the steps to ramp to them
+     *
+     * @param numSamples is the number of samples in the block
+     *
+    */
+    void preparePanning(int numSamples);
+    
+    /**
+     * Renders the voices own LFOs for a block or points to the global LFOs for the block
+     *
+     * @param blockStart is the position in the output buffer of the start of the block
+     * @param blockSamples is the number of samples in the block
+     *
+    */
+    void renderLFOs(int blockStart, int blockSamples);
+    
+    /**
+     * Checks if an LFO needs to be rendered
+     *
+     * @param lfoNum is the LFO to check
+     *
+     * @return true if the LFO depth is not 0 or could be changed by a smoother or parameter envolope
+     *
+    */
+    bool lfoActive(int lfoNum);
+    
+    /**
+     * Applies FX to the block of voice samples
+     *
+     * @param numSamples is the number of samples in the voice block to apply the FX to
+     * @param useFilterBank true to hand the filtering to the filter bank if it can
+     *
+    */
+    void applyFX(int numSamples, bool useFilterBank);
+    
+    /**
+     * Hands the block of voice samples to the filter bank if the filters are all butterworth modes
+     *
+     * @param numSamples is the number of samples in the voice block to filter
+     *
+     * @return true if the block was handed to the filter bank, false if the voice needs to filter it
+     *
+    */
+    bool submitToFilterBank(int numSamples);
+    
+    /**
+     * Applies the LFOs to the block of voice samples
      *
-     * @param sample collects stereo samples and returns the array of samples with FX applied
+     * @param numSamples is the number of samples in the voice block to apply the LFOs to
      *
     */
-    void applyFX(float* sample);
+    void applyLFO(int numSamples);
     
     /**
-     * Gets next samples from the lfos
+     * Filters the block of voice samples
      *
-     * @param sample returns an array of samples with LFOs applied
+     * @param numSamples is the number of samples in the voice block to filter
      *
     */
-    void applyLFO(float* sample);
+    void applyFilter(int numSamples);
     
     /**
-     * Gets next samples from the filters
+     * Checks if the block of voice samples is silent
+     *
+     * @param numSamples is the number of samples in the voice block to check
      *
-     * @param sample returns an array of samples with filters applied
+     * @return true if every sample is smaller than silenceLevel
      *
     */
-    void applyFilter(float* sample);
+    bool checkBlockSilent(int numSamples) const;
+    
+    /**
+     * Counts the denormal samples in the block of voice samples
+     *
+     * @param numSamples is the number of samples in the voice block to check
+     *
+     * @return the number of denormal samples in every channel
+     *
+    */
+    int countBlockDenormals(int numSamples) const;
+    
+    /**
+     * Checks if a filter has no tail left to output
+     *
+     * @param filterNum is the filter to check
+     *
+     * @return true if the filter in use has decayed below silenceLevel
+     *
+    */
+    bool filterSilent(int filterNum) const;
+    
+    /**
+     * Checks which filters have a cut off that changes over the block and sets the cut off of the others
+     *
+    */
+    void prepareFilters();
+    
+    /**
+     * Checks if the drive amount changes over the block and sets it for the block if not
+     *
+    */
+    void prepareDrive();
+    
+    /**
+     * Drives the block of voice samples
+     *
+     * @param numSamples is the number of samples in the voice block to drive
+     *
+    */
+    void applyDrive(int numSamples);
     
     /**
      * Resets the voice to be called once note has finsihed playing
@@ -265,28 +572,69 @@ private:
     /**
      * Updates the parameters
      *
+     * @param numSamples is the number of samples until the next update
+     *
     */
-    void updateParams();
+    void updateParams(int numSamples);
     
     /**
-     * Updates the envoloope parameters
+     * Updates the envoloope parameters once for a block of samples
+     *
+     * @param numSamples is the number of samples in the block
      *
     */
-    void updateEnvParams();
+    void updateEnvParams(int numSamples);
     
     
     /**
      * Updates the oscillator parameters
      *
+     * @param numSamples is the number of samples until the next update
+     *
     */
-    void updateOscParams();
+    void updateOscParams(int numSamples);
     
     /**
      * Updates the LFO parameters
      *
+     * @param numSamples is the number of samples until the next update
+     *
     */
-    void updateLFOParams();
+    void updateLFOParams(int numSamples);
+    
+    /**
+     * Moves a parameters envolope max value on by the samples bettween updates
+     *
+     * @param paramNum is the parameter
+     * @param numSamples is the number of samples to skip
+     *
+    */
+    void skipParamVal(int paramNum, int numSamples);
+    
+    
+    // Hot state, everything the voice reads or writes each sample while it renders. The voice is
+    // built on a cache line in the VoiceArena so the hot state starts on one and stays together
+    
+    //Samples of the first two channels of the voice for the current block before FX and the amp envolope are applied,
+    //aligned so the vector operations on the block can use aligned loads, the right channel stays silent for a mono voice
+    alignas(64) float voiceBlock[2][envBlockSize] = {};
     
+    //Every channel of the block, the surround channels are in the surround storage and null without it
+    float* voiceChannels[maxChannels] = {};
+    
+    //Gain of each source in each surround channel and how much they move each sample to reach the gains for the block
+    float panGains[NumSources][maxChannels] = {};
+    float panGainSteps[NumSources][maxChannels] = {};
+    
+    //Gain of each sample of the block when it is added to the output, the amp envolope scaled by the velocity and output level
+    alignas(32) float outputGainBlock[envBlockSize] = {};
+    
+    //The rendered envolope block and the envolope values for the current sample
+    float envBlock[EnvelopeBank::numLanes * envBlockSize] = {};
+    const float* envVals = envBlock;
+    
+    //Position of the current sample in the block
+    int blockPos = 0;
     
     //Variable to check if voice should be playing
     bool playing = false;
@@ -297,45 +645,402 @@ private:
     //Variable for storing the note velocity
     float noteVelocity=0;
     
-    //LFO Oscillator
-    Oscillator lfoOsc;
-    
-    //Env ADSRs
-    OwnedArray<ADSR> myEnvs;
+    //Amp envolope level at the end of the last block, used to pick the quietest voice to steal
+    float ampLevel = 0.0f;
     
-    //Filters
-    OwnedArray<StereoIIRFilters> synthFilters;
+    //Number of samples played in the last rendered block and if the block is silent, silent blocks skip the FX and are not added to the output
+    int blockPlayed = 0;
+    bool blockSilent = false;
     
-    //Value switches to check if parameters have changed since last checked
-    int envUpdate[8] = {4, 4, 4, 4, 4, 4, 4, 4};
-    int oscUpdate[4] = {4, 4, 4, 4};
-    int lfoUpdate = 4;
-    int filterUpdate[2] = {4, 4};
-    int paramEnvUpdate[5] = {4, 4, 4, 4, 4};
+    //Rendered block of per voice LFO values, pointers to this blocks LFO values, the LFO depths of each
+    //sample in the block and if the LFO is used at all in the block
+    float lfoBlock[NumLFOs][envBlockSize] = {};
+    std::array<const float*, NumLFOs> lfoVals {};
+    float lfoAmpBlock[NumLFOs][envBlockSize] = {};
+    std::array<bool, NumLFOs> lfoUsed {};
     
-    //Array to check if filter enabled
-    bool filterEnable[2] = {false, false};
+    //Filter cut offs of each sample in the block for filters with a changing cut off
+    float filterCutoffBlock[NumFilters][envBlockSize] = {};
+    std::array<bool, NumFilters> filterRamp {};
     
-    //Owned array for smoothing all parameters
-    OwnedArray<MultiSmooth> smoothEnvParams;
-    OwnedArray<MultiSmooth> smoothOscParams;
-    OwnedArray<MultiSmooth> smoothLFOParams;
-    OwnedArray<SmoothChanges> smoothFilterParams;
+    //Drive amount for the block and the amount of each sample if it is changing
+    float driveAmount = 0.0f;
+    float driveAmountBlock[envBlockSize] = {};
+    bool driveRamp = false;
     
-    //Intial oscillator types
-    int oscTypes[4] = {1, 2, 3, 4};
-    
-    //Variable for lfo a,plitude
-    float lfoAmp = 0;
+    //Env ADSRs, amp, X, Y and the parameter envolopes advanced together
+    EnvelopeBank envBank;
     
     //Source oscillators that are modified by X, Y envolopes
     XYEnvolopedOscs sourceOscs;
     
-    //Parameters to deal with envoloping parameters (12 possible parameters to be envoloped)
-    int paramEnvParamsChosen[5] = {0, 0, 0, 0, 0};
-    OwnedArray<SmoothChanges> maxParamsVals;
-    int numTimesChosen[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    float envolopedParamVals[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    bool envolopedParam[14] = {false, false, false, false, false, false, false, false, false, false, false, false, false, false};
+    //LFO Oscillators owned by this voice, used when an LFO is in per voice mode
+    std::array<SynthLFO, NumLFOs> voiceLFOs;
+    
+    //Filters of the first pair of channels and the filters of every pair, the surround pairs are in the surround storage
+    PairFilters frontFilters;
+    std::array<PairFilters*, maxChannelPairs> pairFilters {};
+    
+    //Drive stage bettween the LFO and the filters
+    ADAADrive drive;
+    
+    //Smoothers for all parameters
+    std::array<MultiSmooth, NumEnvs> smoothEnvParams;
+    std::array<MultiSmooth, NumSources> smoothOscParams;
+    std::array<MultiSmooth, NumLFOs> smoothLFOParams;
+    std::array<SmoothChanges, NumFilters> smoothFilterParams;
+    SmoothChanges smoothDriveAmount;
+    
+    //Variable for lfo amplitudes
+    std::array<float, NumLFOs> lfoAmp {};
+    
+    //Max value of each envoloped parameter and its value with the envolopes applied
+    std::array<SmoothChanges, numEnvolopedParams> maxParamsVals;
+    std::array<float, numEnvolopedParams> envolopedParamVals {};
+    
+    // Cold state, settings only read when the parameters change, a note starts or a block is set up,
+    // starting on its own cache line so it is never loaded with the hot state
+    
+    //Samples bettween parameter updates and if quiet released voices are left unfiltered, set by setRenderQuality
+    alignas(64) int controlInterval = 1;
+    bool dropReleasedFilters = false;
+    
+    //Channels rendered and the pairs of them filtered, the right channel of the voice block stays silent for a mono voice
+    int numChannels = 2;
+    int numChannelPairs = 1;
+    
+    //Output channel each channel of the voice is added to
+    int outputChannels[maxChannels] = {0, 1, 2, 3, 4, 5, 6, 7};
+    
+    //Channels and filters past the first pair, built in their own arena the first time the voice is given a surround
+    //output and kept if the output goes back to stereo
+    VoiceArena surroundArena;
+    SurroundChannels* surround = nullptr;
+    
+    //Panner for surround outputs and if the pan gains have been set since the note started
+    const SurroundPanner* panner = nullptr;
+    bool panGainsSet = false;
+    
+    //Number of samples to ramp parameter changes over, 0 uses the smoothers normal smoothing time
+    int paramRampSamples = 0;
+    
+    //LFOs rendered by the processor and shared by all voices and the mode of each LFO
+    const AudioBuffer<float>* globalLFOBuffer = nullptr;
+    std::array<bool, NumLFOs> lfoGlobal {};
+    
+    //Array to check if filter enabled and if it is using the state variable filter or the formant filter
+    std::array<bool, NumFilters> filterEnable {};
+    std::array<bool, NumFilters> filterSVF {};
+    std::array<bool, NumFilters> filterFormant {};
+    
+    //Butterworth mode of each filter, 1 for -12dB/oct and 2 for -24dB/oct, and the cut off set for the block
+    std::array<int, NumFilters> filterOrder;
+    std::array<float, NumFilters> filterCutoff;
+    
+    //Filter bank shared by the voices, this voices lanes in it and if the last block was filtered by it
+    VoiceFilterBank* filterBank = nullptr;
+    int voiceIndex = 0;
+    bool bankFiltering = false;
+    bool bankFilteredLastBlock = false;
+    
+    //Value switches to check if parameters have changed since last checked, set by resetParamSwitches
+    std::array<int, NumEnvs> envUpdate;
+    std::array<int, NumSources> oscUpdate;
+    std::array<int, NumLFOs> lfoUpdate;
+    std::array<int, NumFilters> filterUpdate;
+    int driveUpdate = 4;
+    std::array<int, numParamEnvs> paramEnvUpdate;
+    
+    //Parameters to deal with envoloping parameters, the parameter each envolope changes and how many envolopes change each parameter
+    std::array<int, numParamEnvs> paramEnvParamsChosen {};
+    std::array<int, numEnvolopedParams> numTimesChosen {};
+    std::array<bool, numEnvolopedParams> envolopedParam {};
+    
+    //Denormal results of each stage since the counts were reset
+    int denormalCounts[numDenormalStages] = {0, 0, 0, 0};
+    
+};
+
+//The voice played by the synth, 4 sources, amp, X, Y and 5 parameter envolopes, a low pass and a high pass filter and 2 LFOs
+using PostBoxSynth = PostBoxSynthVoice<4, 8, 2, 2>;
+extern template class PostBoxSynthVoice<4, 8, 2, 2>;
+
+
+// =================================
+// =================================
+// Synthesiser
+
+/*!
+ @class PostBoxSynthesiser
+ @abstract the synthesiser that plays the PostBoxSynth voices
+ @discussion the voices are a pool created up front, up to maxVoices of them, and the polyphony
+             sets how many can play at once. Free voices are kept on a stack and playing voices
+             in an active list, so starting a note takes a voice from the free list without
+             searching and only the active voices are rendered or updated each block. When no
+             voice is free the quietest playing voice is stolen. All the active voices are
+             rendered a block at a time in step with each other so the filters of every voice
+             can be run together by one VoiceFilterBank bettween the voices rendering their
+             oscillators and applying their amp envolopes. When enough voices are playing the
+             active voices are split into fixed groups that are rendered on the VoiceRenderPool
+             shared by every instance in the process, each group into its own buffer, and the
+             group buffers are added to the output in group order so the output is the same
+             whichever thread rendered each group
+ 
+ @namespace none
+ @updated 2026-10-19
+ */
+class PostBoxSynthesiser : public Synthesiser,
+                           private VoiceRenderPool::JobList
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    PostBoxSynthesiser();
+    /** Destructor*/
+    ~PostBoxSynthesiser(){};
+    //==============================================================================
+    
+    //Most voices that can be added to the pool
+    static constexpr int maxVoices = 128;
+    
+    //Voices rendered by each job when rendering in parallel
+    static constexpr int voicesPerJob = 4;
+    
+    //Fewest active voices and samples in a block to render in parallel, below these waking the
+    //workers costs more than it saves
+    static constexpr int parallelVoiceThreshold = 12;
+    static constexpr int parallelBlockThreshold = 16;
+    
+    /**
+     * Sets the parameters passed to the voices, they must live as long as the synthesiser
+     *
+     * @param envs is an array of envolope parameters
+     * @param oscs is an array of oscillator parameters
+     * @param lfos is an array of lfo parameters
+     * @param filters is an array of filter parameters
+     * @param drive is the drive mode and amount
+     * @param paramEnvsChoice is an array of parameter envolope parameters
+     *
+    */
+    void setParamSources(OwnedArray<EnvolopeParams>* envs, OwnedArray<SimpleParams>* oscs, OwnedArray<SimpleParams>* lfos, OwnedArray<SimpleParams>* filters, SimpleParams* drive, OwnedArray<SimpleParams>* paramEnvsChoice);
+    
+    /**
+     * Sets up the voice pool, the filter bank and the render workers for the voices that have been
+     * added and initialises every voice, call after adding the voices and not from the audio thread
+     *
+     * @param sampleRate is the sampleRate in samples / s
+     * @param globalLFOBuffer is the buffer of global LFOs rendered by the processor
+     * @param outputLayout is the layout of the output bus, the voices render in mono for a mono output and
+     *                     a channel for each speaker for a surround output
+     *
+    */
+    void prepareVoices(float sampleRate, const AudioBuffer<float>* globalLFOBuffer, const AudioChannelSet& outputLayout);
+    
+    /**
+     * Sets how far in front or behind the listener a source is placed on a surround output
+     *
+     * @param source is the source from 0 -> SurroundPanner::maxSources
+     * @param depth is the position from -1 behind to 1 in front
+     *
+    */
+    void setSourceDepth(int source, float depth) { panner.setSourceDepth(source, depth); }
+    
+    /**
+     * Passes changed parameters to the active voices, the others are updated when they start
+     *
+     * @param rampSamples is the number of samples to ramp changed parameters over, 0 uses the normal smoothing time
+     *
+    */
+    void updateVoiceParams(int rampSamples);
+    
+    /**
+     * Sets the curve of all the envolopes of every voice
+     *
+     * @param newCurve is the curve from 0 -> 1
+     *
+    */
+    void setEnvCurve(float newCurve);
+    
+    /**
+     * Sets how much detail every voice renders with
+     *
+     * @param controlInterval is the number of samples bettween voice parameter updates
+     * @param dropReleasedFilters is true to stop filtering quiet released voices
+     *
+    */
+    void setRenderQuality(int controlInterval, bool dropReleasedFilters);
+    
+    /**
+     * Sets how many voices can play at once
+     *
+     * @param newPolyphony is the number of voices from 1 -> maxVoices, voices already playing
+     *                     above a lowered polyphony are left to finish
+     *
+    */
+    void setPolyphony(int newPolyphony);
+    
+    /**
+     * Sets when the next call to renderNextBlock needs to be finished, passed on to the render
+     * pool so that the instance with the least time left gets the workers first
+     *
+     * @param newDeadline is the deadline in high resolution ticks
+     *
+    */
+    void setRenderDeadline(int64 newDeadline) { renderDeadline = newDeadline; }
+    
+    /**
+     * Gets the number of voices playing
+     *
+     * @return the number of voices in the active list
+     *
+    */
+    int getNumActiveVoices() const { return numActive; }
+    
+    /**
+     * Gets a voice from the pool
+     *
+     * @param index is the index of the voice from 0 -> getNumVoices()
+     *
+     * @return the voice
+     *
+    */
+    PostBoxSynth* getPoolVoice(int index) const;
+    
+    /**
+     * Checks if any playing voice is reading a global LFO
+     *
+     * @param lfoNum is the LFO to check
+     *
+     * @return true if an active voice still uses the LFO rendered by the processor
+     *
+    */
+    bool globalLFOInUse(int lfoNum) const;
+    
+    /**
+     * Starts a note on a voice from the free list, or steals the quietest voice if none are free
+     *
+     * @param midiChannel is the midi channel of the note
+     * @param midiNoteNumber is the midi note number
+     * @param velocity is the velocity of the note from 0 -> 1
+     *
+    */
+    void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+    
+protected:
+    
+    /**
+     * Renders the active voices in envolope sized blocks with the filter bank processed in the middle of each block
+     *
+     * @param outputAudio is the buffer to add the voices to
+     * @param startSample is the position of the first sample to render
+     * @param numSamples is the number of samples to render
+     *
+    */
+    void renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+    
+private:
+    
+    /**
+     * Takes a voice off the free list or picks one to steal
+     *
+     * @return the index of the voice, or -1 if there is no voice to use
+     *
+    */
+    int allocateVoice();
+    
+    /**
+     * Moves a voice from the active list to the free list
+     *
+     * @param voiceNum is the index of the voice
+     *
+    */
+    void freeVoice(int voiceNum);
+    
+    /**
+     * Moves every voice that has stopped playing to the free list
+     *
+    */
+    void releaseFinishedVoices();
+    
+    /**
+     * Brings a voice that is about to start up to date with the parameters
+     *
+     * @param voiceNum is the index of the voice
+     *
+    */
+    void syncVoice(int voiceNum);
+    
+    /**
+     * Renders one envolope block of the active voices on the render pool
+     *
+     * @param outputAudio is the buffer to add the voices to
+     * @param blockStart is the position of the first sample of the block
+     * @param blockSamples is the number of samples in the block
+     *
+     * @return true if any voice is playing
+     *
+    */
+    bool renderBlockParallel(AudioBuffer<float>& outputAudio, int blockStart, int blockSamples);
+    
+    /**
+     * Runs one job of the current render stage on a group of voicesPerJob active voices
+     *
+     * @param jobIndex is the group of voices
+     *
+    */
+    void runJob(int jobIndex) override;
+    
+    //Stages of a parallel block, the filter bank is processed bettween them
+    enum RenderStage
+    {
+        renderStage = 0,
+        finishStage
+    };
+    
+    //Filters of all the voices
+    VoiceFilterBank filterBank;
+    
+    //Speaker gains the voices pan their sources with on a surround output
+    SurroundPanner panner;
+    
+    //Every voice in the pool, cast once when the pool is prepared
+    Array<PostBoxSynth*> voicePool;
+    
+    //Free voices as a stack, active voices and the position of each voice in the active list
+    HeapBlock<int> freeVoices;
+    HeapBlock<int> activeVoices;
+    HeapBlock<int> activePositions;
+    int numFree = 0;
+    int numActive = 0;
+    
+    //Number of voices that can play at once
+    int polyphony = 8;
+    
+    //Last voice started on each midi note
+    int noteVoices[128];
+    
+    //Parameters passed to the voices
+    OwnedArray<EnvolopeParams>* envParams = nullptr;
+    OwnedArray<SimpleParams>* oscParams = nullptr;
+    OwnedArray<SimpleParams>* lfoParams = nullptr;
+    OwnedArray<SimpleParams>* filterParams = nullptr;
+    SimpleParams* driveParams = nullptr;
+    OwnedArray<SimpleParams>* paramEnvParams = nullptr;
+    
+    //Counts the parameter updates, each voice keeps the count it was last updated at
+    int paramVersion = 0;
+    HeapBlock<int> voiceParamVersions;
+    
+    //Envolope curve of every voice
+    float envCurve = 0.0f;
     
+    //Worker threads shared with the other instances, when the block needs to be finished, the stage and block being
+    //rendered by the jobs, each groups output and if any voice in it played
+    std::shared_ptr<VoiceRenderPool> renderPool;
+    int64 renderDeadline = 0;
+    RenderStage jobStage = renderStage;
+    int jobBlockStart = 0;
+    int jobBlockSamples = 0;
+    OwnedArray<AudioBuffer<float>> groupBuffers;
+    HeapBlock<bool> groupPlaying;
 };
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+    Watches how long each block takes to render compared to the time the
+    block lasts and steps the render quality down when the load gets high
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+QualityGovernor::QualityGovernor(){}
+
+QualityGovernor::~QualityGovernor(){}
+
+void QualityGovernor::setThresholds(float newStepDownLoad, float newStepUpLoad)
+{
+    const float downLoad = jlimit(0.01f, 1.0f, newStepDownLoad);
+    stepDownLoad = downLoad;
+    stepUpLoad = jlimit(0.0f, downLoad, newStepUpLoad);     //Must be below the step down load or the stages would flap
+}
+
+void QualityGovernor::setHoldTime(double newHoldTime)
+{
+    holdTime = jmax(0.0, newHoldTime);
+}
+
+int QualityGovernor::update(double renderTime, double blockTime)
+{
+    if(blockTime <= 0.0)
+        return stage;
+
+    //Reading the thresholds once so a change part way through does not mix old and new values
+    const float downLoad = stepDownLoad.load();
+    const float upLoad = jmin(stepUpLoad.load(), downLoad);
+    const float blockLoad = (float) (renderTime / blockTime);
+    int newStage = stage.load();
+    load = blockLoad;
+
+    if(blockLoad > downLoad)     //Dropping a stage straight away, the next block is rendered at the lower quality
+    {
+        newStage = jmin(newStage + 1, numStages - 1);
+        timeBelow = 0.0;
+    }
+    else if(blockLoad < upLoad && newStage > fullQuality)   //Only going back up once the load has been low for the hold time
+    {
+        timeBelow += blockTime;
+        if(timeBelow >= holdTime.load())
+        {
+            --newStage;
+            timeBelow = 0.0;
+        }
+    }
+    else
+    {
+        timeBelow = 0.0;
+    }
+
+    stage = newStage;
+    return newStage;
+}
+
+void QualityGovernor::reset()
+{
+    stage = fullQuality;
+    load = 0.0f;
+    timeBelow = 0.0;
+}
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Watches how long each block takes to render compared to the time the
+    block lasts and steps the render quality down when the load gets high
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+
+// =================================
+// =================================
+// Quality Governor
+
+/*!
+ @class QualityGovernor
+ @abstract picks a render quality stage from the measured load of each block
+ @discussion the load is the time a block took to render divided by the length of the block,
+             1 means the block only just finished before it was due. One block over the step down
+             load drops a stage straight away as waiting would risk an xrun, a stage is only
+             stepped back up once the load has stayed under the step up load for the hold time.
+             The gap bettween the two loads and the hold stops the stages flapping as the lower
+             quality brings the load down. The thresholds and hold time can be set from the
+             message thread while update runs on the audio thread, so they are atomic, as are
+             the stage and load for reading back
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class QualityGovernor
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    QualityGovernor();
+    /** Destructor*/
+    ~QualityGovernor();
+    //==============================================================================
+
+    //Quality stages, each one keeps the savings of the stages before it
+    enum Stage
+    {
+        fullQuality = 0,        //Everything rendered as normal
+        coarseControl,          //Voice parameters updated every few samples instead of every sample
+        releasedFiltersOff,     //Quiet released voices are not filtered
+        polyphonyCapped,        //Polyphony lowered so new notes steal voices sooner
+        numStages
+    };
+
+    //Samples bettween voice parameter updates from the coarseControl stage
+    static constexpr int coarseControlInterval = 4;
+
+    /**
+     * Sets the loads the stages change at
+     *
+     * @param newStepDownLoad is the load above which a block drops a stage, from 0 -> 1
+     * @param newStepUpLoad is the load the blocks must stay under to go back up a stage, below newStepDownLoad
+     *
+    */
+    void setThresholds(float newStepDownLoad, float newStepUpLoad);
+
+    /**
+     * Sets how long the load has to stay low before going back up a stage
+     *
+     * @param newHoldTime is the time in s
+     *
+    */
+    void setHoldTime(double newHoldTime);
+
+    /**
+     * Measures the load of a block and picks the stage for the next block
+     *
+     * @param renderTime is the time the block took to render in s
+     * @param blockTime is the length of the block in s
+     *
+     * @return the stage to render the next block at
+     *
+    */
+    int update(double renderTime, double blockTime);
+
+    /**
+     * Goes back to full quality, called when playback is prepared
+     *
+    */
+    void reset();
+
+    /**
+     * Gets the stage to render at
+     *
+     * @return one of the values in Stage
+     *
+    */
+    int getStage() const { return stage.load(); }
+
+    /**
+     * Gets the load of the last block
+     *
+     * @return the render time of the last block divided by its length
+     *
+    */
+    float getLoad() const { return load.load(); }
+
+private:
+    //Loads the stages change at and how long the load has to stay low before stepping up in s
+    std::atomic<float> stepDownLoad { 0.75f };
+    std::atomic<float> stepUpLoad { 0.4f };
+    std::atomic<double> holdTime { 2.0 };
+
+    //Current stage and the load of the last block
+    std::atomic<int> stage { fullQuality };
+    std::atomic<float> load { 0.0f };
+    
+    //How long the load has been under the step up load, only used on the audio thread
+    double timeBelow = 0.0;
+};
@@ -51,6 +51,30 @@ void SmoothChanges::setTargetVal(float targetVal)
     //Otherwise make no change
 }
 
+void SmoothChanges::setTargetVal(float targetVal, int rampSamples)
+{
+    if(rampSamples <= 0)    //No ramp length so use the smoothing time
+    {
+        setTargetVal(targetVal);
+        return;
+    }
+    
+    if(targetVal != targetValue) //Checking target value changed
+    {
+        targetValue = targetVal;
+        if(lastValue != targetVal) //Checking not already reached target
+        {
+            increment = (targetValue - lastValue) / rampSamples;   //Calculate the increment to reach the target at the end of the ramp
+            valueChanging = true;
+        }
+        else
+        {
+            valueChanging = false;  //If target reached reset the increment and stop changing
+            increment = 0.0;
+        }
+    }
+}
+
 void SmoothChanges::setSampleRate(float newSampleRate)
 {
     sampleRate= newSampleRate > 0 ? newSampleRate : 48000; //Check passed sample rate bigger than zero if not set as default value
@@ -97,6 +121,21 @@ float SmoothChanges::getNextVal()
     return targetValue;             //If no increment then just output the target value
 }
 
+void SmoothChanges::skip(int numSamples)
+{
+    if(valueChanging && numSamples > 0)   //Check value is changing
+    {
+        lastValue += increment * numSamples;    //Incrementing the value by the number of samples skipped
+        
+        if((increment > 0.0f && lastValue >= targetValue) || (increment <= 0.0f && lastValue <= targetValue))  //Checking value exceeded target if so stop at target
+        {
+            lastValue = targetValue;
+            increment = 0;
+            valueChanging = false;
+        }
+    }
+}
+
 bool SmoothChanges::checkChanging()
 {
     return valueChanging;   //Return if value is changing
@@ -141,7 +180,7 @@ void MultiSmooth::init(float* currentVal, float* targetVal)
 {
     for(int i = 0; i < numberParams; ++i)  //Reinitialising the array with the updated current and target values
     {
-        paramSmooth[i] -> init(currentVal[i], targetVal[i], smoothTime);
+        paramSmooth[i].init(currentVal[i], targetVal[i], smoothTime);
     }
 }
 
@@ -149,7 +188,15 @@ void MultiSmooth::setTargetVal(float* targetVal)
 {
     for(int i=0; i < numberParams; ++i)    //Update target value for all parts of the envolope
     {
-        paramSmooth[i] -> setTargetVal(targetVal[i]);
+        paramSmooth[i].setTargetVal(targetVal[i]);
+    }
+}
+
+void MultiSmooth::setTargetVal(float* targetVal, int rampSamples)
+{
+    for(int i=0; i < numberParams; ++i)    //Update target value for all parts of the envolope
+    {
+        paramSmooth[i].setTargetVal(targetVal[i], rampSamples);
     }
 }
 
@@ -157,7 +204,15 @@ void MultiSmooth::getNextVal(float *params)
 {
     for(int i = 0; i < numberParams; ++i)  //Update params with next smoothed value
     {
-        params[i] = paramSmooth[i] -> getNextVal();
+        params[i] = paramSmooth[i].getNextVal();
+    }
+}
+
+void MultiSmooth::skip(int numSamples)
+{
+    for(int i = 0; i < numberParams; ++i)  //Skip each param forward
+    {
+        paramSmooth[i].skip(numSamples);
     }
 }
 
@@ -165,19 +220,18 @@ void MultiSmooth::setSampleRate(float newSampleRate)
 {
     for(int i = 0; i < numberParams; ++i)  //Updating the sampleRate for each parameter
     {
-        paramSmooth[i] -> setSampleRate(newSampleRate);
+        paramSmooth[i].setSampleRate(newSampleRate);
     }
 }
 
 void MultiSmooth::setNumParams(int numParams)
 {
-    paramSmooth.clear();    //Clear param array
-
-    numberParams = numParams;   //Update number of parameters
+    jassert(numParams >= 0 && numParams <= maxParams);  //The smoothers are held inside the class
+    numberParams = jlimit(0, maxParams, numParams);   //Update number of parameters
     
-    for(int i = 0; i < numberParams; ++i)  //Initialising an owned array of parameter smoothers
+    for(int i = 0; i < numberParams; ++i)  //Resetting the parameter smoothers in use
     {
-        paramSmooth.add(new SmoothChanges());
+        paramSmooth[i] = SmoothChanges();
     }
 }
 
@@ -186,7 +240,7 @@ bool MultiSmooth::checkChanging()
 {
     for(int i = 0; i < numberParams; ++i)   //Returns true if any values are still changing
     {
-        if(paramSmooth[i] -> checkChanging())
+        if(paramSmooth[i].checkChanging())
         {
             return true;
         }
@@ -201,6 +255,6 @@ void MultiSmooth::setToTarget()
 {
     for(int i = 0; i < numberParams; ++i)   //Iterate through all params and set them to target value
     {
-        paramSmooth[i] -> setToTarget();
+        paramSmooth[i].setToTarget();
     }
 }
@@ -70,6 +70,16 @@ public:
     */
     void setTargetVal(float targetVal);
     
+    /**
+     * Sets a new target that is reached in a set number of samples rather than the smoothing time,
+     * used to follow host automation as a straight line ramp bettween blocks
+     *
+     * @param targetVal is the target value
+     * @param rampSamples is the number of samples to reach the target in, 0 or less uses the smoothing time
+     *
+    */
+    void setTargetVal(float targetVal, int rampSamples);
+    
     /**
      * Sets the sample rate of the processor
      *
@@ -94,6 +104,14 @@ public:
     */
     float getNextVal();
     
+    /**
+     * Skips the smoothed parameter forward by a number of samples
+     *
+     * @param numSamples is the number of samples to skip
+     *
+    */
+    void skip(int numSamples);
+    
     /**
      * Checks if the value is currently being smoothed
      *
@@ -140,10 +158,11 @@ private:
 /*!
  @class MultiSmooth
  @abstract smooth multiple parameters from current to a target value in a set amount of time
- @discussion called to avoid clicking when user is changing parameters
+ @discussion called to avoid clicking when user is changing parameters, smooths up to
+             maxParams parameters
  
  @namespace none
- @updated 2020-04-24
+ @updated 2026-10-19
  */
 class MultiSmooth
 {
@@ -184,6 +203,15 @@ public:
     */
     void setTargetVal(float* targetVals);
     
+    /**
+     * Sets new targets that are reached in a set number of samples rather than the smoothing time
+     *
+     * @param targetVal is a array of target values
+     * @param rampSamples is the number of samples to reach the targets in, 0 or less uses the smoothing time
+     *
+    */
+    void setTargetVal(float* targetVals, int rampSamples);
+    
     /**
      * Sets the sample rate of the processor
      *
@@ -208,6 +236,14 @@ public:
     */
     void getNextVal(float* params);
     
+    /**
+     * Skips all the smoothed parameters forward by a number of samples
+     *
+     * @param numSamples is the number of samples to skip
+     *
+    */
+    void skip(int numSamples);
+    
     /**
      * Checks if any values being smoothed are still changing
      *
@@ -225,7 +261,10 @@ public:
     void setToTarget();
     
 private:
-    OwnedArray<SmoothChanges> paramSmooth;   //Owned array of parameter smoothing class to smooth each param
+    //Most parameters one smoother can smooth
+    static constexpr int maxParams = 4;
+    
+    SmoothChanges paramSmooth[maxParams];   //Array of parameter smoothing class to smooth each param, held inside so it needs no allocation
     
     float smoothTime = 50.0f;
     
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.cpp
+    Zero delay feedback state variable filter with resonance that filters
+    stereo samples and can have its cut off changed every sample
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "StateVariableFilter.h"
+
+ZDFStateVariableFilter::ZDFStateVariableFilter()
+{
+    g = calcGain(cutOffFreq);   //Calculating intial coefficients from default settings
+    calcCoeffs();
+}
+
+ZDFStateVariableFilter::~ZDFStateVariableFilter(){}
+
+void ZDFStateVariableFilter::setSampleRate(float newSampleRate)
+{
+    const double sampleRate = newSampleRate > 0 ? newSampleRate : 48000;   //Check passed sample rate bigger than zero if not set as default value
+    sampleTime = 1.0 / sampleRate;
+    maxFreq = 0.49 * sampleRate;
+    g = calcGain(cutOffFreq);   //The warped gain depends on the sample rate
+    calcCoeffs();
+}
+
+void ZDFStateVariableFilter::setFilterType(int newType)
+{
+    newType = (newType < lowPass || newType > notch) ? (int) lowPass : newType;    //If out of range set to low pass
+    if(type != newType)
+    {
+        type = newType;
+        calcCoeffs();
+    }
+}
+
+void ZDFStateVariableFilter::setFilterCutOffFreq(float newCutOffFreq)
+{
+    if(cutOffFreq != newCutOffFreq) //Only recalculate if the cut off has changed
+    {
+        cutOffFreq = newCutOffFreq;
+        g = calcGain(cutOffFreq);
+        calcCoeffs();
+    }
+}
+
+void ZDFStateVariableFilter::setResonance(float newResonance)
+{
+    newResonance = newResonance < 0.0f ? 0.0f : (newResonance > 1.0f ? 1.0f : newResonance);
+    if(resonance != newResonance)
+    {
+        resonance = newResonance;
+        calcCoeffs();
+    }
+}
+
+void ZDFStateVariableFilter::resetFilter()
+{
+    for(int i = 0; i < 2; ++i)
+    {
+        for(int ch = 0; ch < numChannels; ++ch)
+            state[i][ch] = 0.0;
+    }
+}
+
+bool ZDFStateVariableFilter::isSilent(double level) const
+{
+    for(int i = 0; i < 2; ++i)
+    {
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            if(std::abs(state[i][ch]) >= level)
+                return false;
+        }
+    }
+    return true;
+}
+
+void ZDFStateVariableFilter::calcCoeffs()
+{
+    //Damping goes from a Q of 0.707 with no resonance to a Q of 20 at full resonance
+    k = 1.4142135623730951 - 1.3642135623730951 * resonance;
+
+    //Gains of the feedback loop solved for the current input
+    a1 = 1.0 / (1.0 + g * (g + k));
+    a2 = g * a1;
+    a3 = g * a2;
+
+    //Every output is a mix of the input, band pass and low pass signals
+    switch(type)
+    {
+        case highPass:
+            mixInput = 1.0;
+            mixBand = -k;
+            mixLow = -1.0;
+            break;
+
+        case bandPass:  //Scaled by the damping so the peak stays at unity gain as the resonance goes up
+            mixInput = 0.0;
+            mixBand = k;
+            mixLow = 0.0;
+            break;
+
+        case notch:
+            mixInput = 1.0;
+            mixBand = -k;
+            mixLow = 0.0;
+            break;
+
+        case lowPass:
+        default:
+            mixInput = 0.0;
+            mixBand = 0.0;
+            mixLow = 1.0;
+            break;
+    }
+}
+
+void ZDFStateVariableFilter::process(float* const* channels, int numSamples, const float* cutoffRamp)
+{
+    float* left = channels[0];
+    float* right = channels[1];
+
+    //Working from locals so the states and coefficients stay in registers through the loop
+    alignas(16) double ic1[numChannels] = {state[0][0], state[0][1]};
+    alignas(16) double ic2[numChannels] = {state[1][0], state[1][1]};
+    double localA1 = a1, localA2 = a2, localA3 = a3;
+    const double localK = k;
+    const double m0 = mixInput, m1 = mixBand, m2 = mixLow;
+    float lastCutoff = cutOffFreq;
+
+    for(int i = 0; i < numSamples; ++i)
+    {
+        if(cutoffRamp != nullptr && cutoffRamp[i] != lastCutoff)   //Only a tan and a division when the cut off moves
+        {
+            lastCutoff = cutoffRamp[i];
+            const double gain = calcGain(lastCutoff);
+            localA1 = 1.0 / (1.0 + gain * (gain + localK));
+            localA2 = gain * localA1;
+            localA3 = gain * localA2;
+        }
+
+        alignas(16) double v0[numChannels] = {left[i], right[i]};
+        alignas(16) double output[numChannels];
+
+        //Each line works on both channels with the same coefficients so it maps onto one vector operation
+        for(int ch = 0; ch < numChannels; ++ch)
+        {
+            const double v3 = v0[ch] - ic2[ch];
+            const double v1 = localA1 * ic1[ch] + localA2 * v3;             //Band pass
+            const double v2 = ic2[ch] + localA2 * ic1[ch] + localA3 * v3;   //Low pass
+            ic1[ch] = 2.0 * v1 - ic1[ch];
+            ic2[ch] = 2.0 * v2 - ic2[ch];
+            output[ch] = m0 * v0[ch] + m1 * v1 + m2 * v2;
+        }
+
+        left[i] = (float) output[0];
+        right[i] = (float) output[1];
+    }
+
+    for(int ch = 0; ch < numChannels; ++ch) //Storing the states for the next block, flushing states too small to hear
+    {
+        state[0][ch] = Denormals::flush(ic1[ch]);
+        state[1][ch] = Denormals::flush(ic2[ch]);
+    }
+
+    if(cutoffRamp != nullptr && numSamples > 0 && lastCutoff != cutOffFreq)  //Keep the coefficients of the last cut off
+    {
+        cutOffFreq = lastCutoff;
+        g = calcGain(cutOffFreq);
+        calcCoeffs();
+    }
+}
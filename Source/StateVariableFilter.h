@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.h
+    Zero delay feedback state variable filter with resonance that filters
+    stereo samples and can have its cut off changed every sample
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>    //Including cmath for maths functions
+#include "Denormals.h"
+
+// =================================
+// =================================
+// ZDF State Variable Filter
+
+/*!
+ @class ZDFStateVariableFilter
+ @abstract a resonant low pass, high pass, band pass or notch filter for stereo samples
+ @discussion the topology preserving transform of the analog state variable filter, the two
+             integrators are trapezoidal and the feedback loop is solved each sample so there is
+             no added delay. Changing the cut off only needs one tan and a few multiplies and
+             the filter stays stable however fast the cut off moves, so it can follow an audio
+             rate cut off ramp. Both channels share the coefficients and their states are
+             stored side by side so a stereo frame is filtered as one pair of doubles
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class ZDFStateVariableFilter
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    ZDFStateVariableFilter();
+
+    /** Destructor*/
+    ~ZDFStateVariableFilter();
+    //==============================================================================
+
+    //Outputs the filter can be set to
+    enum FilterType
+    {
+        lowPass = 0,
+        highPass,
+        bandPass,
+        notch
+    };
+
+    /**
+     * Set the sample rate of the filter
+     *
+     * @param newSampleRate is the updated sample rate
+     *
+    */
+    void setSampleRate(float newSampleRate);
+
+    /**
+     * Set the output of the filter
+     *
+     * @param newType is one of the values in FilterType
+     *
+    */
+    void setFilterType(int newType);
+
+    /**
+     * Set the filters cut off frequency
+     *
+     * @param newCutOffFreq is the new cut off frequency in Hz
+     *
+    */
+    void setFilterCutOffFreq(float newCutOffFreq);
+
+    /**
+     * Set the resonance of the filter
+     *
+     * @param newResonance is the resonance from 0 -> 1, 0 is a butterworth response
+     *                     and 1 is just below self oscillation
+     *
+    */
+    void setResonance(float newResonance);
+
+    /**
+     * Filters a block of stereo samples in place
+     *
+     * @param channels is an array of 2 channel pointers, left and right, each holding numSamples samples
+     * @param numSamples is the number of samples to filter
+     * @param cutoffRamp is an array of numSamples cut off frequencies in Hz to use for each sample,
+     *                   or nullptr to keep the current cut off for the whole block
+     *
+    */
+    void process(float* const* channels, int numSamples, const float* cutoffRamp);
+
+    /**
+     * Method to reset the filter integrator states
+     *
+    */
+    void resetFilter();
+
+    /**
+     * Checks if the filter has no tail left to output
+     *
+     * @param level is the level below which a state counts as silent
+     *
+     * @return true if both integrator states of both channels are smaller than level
+     *
+    */
+    bool isSilent(double level) const;
+
+private:
+
+    /**
+     * Calculates the integrator gain for a cut off
+     *
+     * @param freq is the cut off frequency in Hz
+     *
+     * @return the frequency warped integrator gain
+     *
+    */
+    inline double calcGain(float freq) const
+    {
+        //Keep the cut off below nyquist where tan blows up
+        const double limitedFreq = freq < 10.0f ? 10.0 : (freq > maxFreq ? maxFreq : (double) freq);
+        return std::tan(PI * limitedFreq * sampleTime);
+    }
+
+    /**
+     * Calculates the coefficients from the integrator gain and the output mix from the filter type
+     *
+    */
+    void calcCoeffs();
+
+    //Maximum number of channels
+    static constexpr int numChannels = 2;
+
+    //Integrator states stored as [integrator][channel] so the left and right values sit next to each other
+    alignas(16) double state[2][numChannels] = {{0.0, 0.0}, {0.0, 0.0}};
+
+    //Filter settings
+    int type = lowPass;
+    float cutOffFreq = 1000.0f;
+    float resonance = 0.0f;
+
+    //Sample time in s and the highest cut off allowed at this sample rate
+    double sampleTime = 1.0/48000;
+    double maxFreq = 0.49 * 48000;
+
+    //Pi to be used in calculations
+    double PI = 3.14159265358979;
+
+    //Integrator gain g, damping k which is 1/Q and the gains of the solved feedback loop
+    double g = 0.0;
+    double k = 2.0;
+    double a1 = 1.0;
+    double a2 = 0.0;
+    double a3 = 0.0;
+
+    //Amounts of the input, band pass and low pass signals mixed to make the output
+    double mixInput = 0.0;
+    double mixBand = 0.0;
+    double mixLow = 1.0;
+};
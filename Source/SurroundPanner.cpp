@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    SurroundPanner.cpp
+    Turns the 2D position of a source into a gain for each speaker of a
+    surround output layout using a table of pairwise panning gains
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "SurroundPanner.h"
+#include <cmath>    //Including cmath for maths functions
+
+SurroundPanner::SurroundPanner(){}
+
+SurroundPanner::~SurroundPanner(){}
+
+void SurroundPanner::setLayout(const AudioChannelSet& layout)
+{
+    const int numChannels = jmin(layout.size(), maxChannels);
+
+    bool hasCentre = false;
+    for(int ch = 0; ch < numChannels; ++ch)
+        hasCentre = hasCentre || layout.getTypeOfChannel(ch) == AudioChannelSet::centre;
+
+    //Collecting the speakers that can be panned to, kept sorted by direction
+    numSpeakers = 0;
+    for(int ch = 0; ch < numChannels; ++ch)
+    {
+        const float azimuth = getSpeakerAzimuth(layout.getTypeOfChannel(ch), hasCentre);
+        if(azimuth < -180.0f)
+            continue;
+
+        const float radians = (float) (azimuth * PI / 180.0);
+        int pos = numSpeakers;
+        for(; pos > 0 && speakerAzimuths[pos - 1] > radians; --pos)
+        {
+            speakerAzimuths[pos] = speakerAzimuths[pos - 1];
+            speakerChannels[pos] = speakerChannels[pos - 1];
+        }
+        speakerAzimuths[pos] = radians;
+        speakerChannels[pos] = ch;
+        ++numSpeakers;
+    }
+
+    for(int t = 0; t <= tableSize; ++t)     //Working out the gains for every direction
+    {
+        const double direction = 2.0 * PI * t / tableSize - PI;
+        float* gains = gainTable[t];
+        for(int s = 0; s < maxChannels; ++s)
+            gains[s] = 0.0f;
+
+        if(numSpeakers == 1)
+        {
+            gains[0] = 1.0f;
+            continue;
+        }
+        if(numSpeakers == 0)
+            continue;
+
+        //The pair of speakers either side of the direction, the last speaker pairs with the first across the back
+        int second = 0;
+        while(second < numSpeakers && speakerAzimuths[second] <= direction)
+            ++second;
+        second = second % numSpeakers;
+        const int first = (second + numSpeakers - 1) % numSpeakers;
+
+        //Solving for the gains of the pair that add up to the direction, x is to the right and y in front
+        const double a1 = speakerAzimuths[first];
+        const double a2 = speakerAzimuths[second];
+        const double px = std::sin(direction);
+        const double py = std::cos(direction);
+        const double det = std::sin(a1 - a2);
+
+        double g1 = 0.5, g2 = 0.5;
+        if(std::abs(det) > 0.000001)    //Speakers opposite each other have no pair to pan bettween so share the gain
+        {
+            g1 = std::max(0.0, (px * std::cos(a2) - py * std::sin(a2)) / det);
+            g2 = std::max(0.0, (py * std::sin(a1) - px * std::cos(a1)) / det);
+        }
+
+        //Constant power across the pair
+        const double norm = std::sqrt(g1 * g1 + g2 * g2);
+        gains[first] = norm > 0.0 ? (float) (g1 / norm) : 0.0f;
+        gains[second] = norm > 0.0 ? (float) (g2 / norm) : 0.0f;
+    }
+}
+
+void SurroundPanner::setSourceDepth(int source, float depth)
+{
+    jassert(source >= 0 && source < maxSources);
+    sourceDepths[source] = jlimit(-1.0f, 1.0f, depth);
+}
+
+void SurroundPanner::getSourceGains(int source, float pan, float* gains) const
+{
+    getGains(pan, sourceDepths[source], gains);
+}
+
+void SurroundPanner::getGains(float x, float y, float* gains) const
+{
+    if(numSpeakers == 0)
+        return;
+
+    const float uniform = 1.0f / std::sqrt((float) numSpeakers);
+    const float radius = std::sqrt(x * x + y * y);
+
+    if(radius < 0.0001f)    //The centre of the room has no direction, every speaker is the same
+    {
+        for(int s = 0; s < numSpeakers; ++s)
+            gains[s] = uniform;
+        return;
+    }
+
+    //Interpolating bettween the two closest directions in the table
+    const double position = (std::atan2((double) x, (double) y) + PI) / (2.0 * PI) * tableSize;
+    const int row = jlimit(0, tableSize - 1, (int) position);
+    const float frac = (float) (position - row);
+    const float* below = gainTable[row];
+    const float* above = gainTable[row + 1];
+
+    //Positions inside the circle are spread towards every speaker, then the gains are brought back to constant power
+    const float spread = radius < 1.0f ? 1.0f - radius : 0.0f;
+    float power = 0.0f;
+    for(int s = 0; s < numSpeakers; ++s)
+    {
+        const float gain = below[s] + frac * (above[s] - below[s]);
+        gains[s] = (1.0f - spread) * gain + spread * uniform;
+        power += gains[s] * gains[s];
+    }
+
+    const float scale = power > 0.0f ? 1.0f / std::sqrt(power) : 0.0f;
+    for(int s = 0; s < numSpeakers; ++s)
+        gains[s] *= scale;
+}
+
+float SurroundPanner::getSpeakerAzimuth(AudioChannelSet::ChannelType type, bool hasCentre)
+{
+    switch(type)
+    {
+        case AudioChannelSet::left:                 return hasCentre ? -30.0f : -45.0f;
+        case AudioChannelSet::right:                return hasCentre ? 30.0f : 45.0f;
+        case AudioChannelSet::centre:               return 0.0f;
+        case AudioChannelSet::leftSurround:         return hasCentre ? -110.0f : -135.0f;
+        case AudioChannelSet::rightSurround:        return hasCentre ? 110.0f : 135.0f;
+        case AudioChannelSet::leftSurroundSide:     return -90.0f;
+        case AudioChannelSet::rightSurroundSide:    return 90.0f;
+        case AudioChannelSet::leftSurroundRear:     return -150.0f;
+        case AudioChannelSet::rightSurroundRear:    return 150.0f;
+        case AudioChannelSet::centreSurround:       return 180.0f;
+        default:                                    return -1000.0f;    //LFE and channels with no direction
+    }
+}
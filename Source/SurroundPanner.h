@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    SurroundPanner.h
+    Turns the 2D position of a source into a gain for each speaker of a
+    surround output layout using a table of pairwise panning gains
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+
+// =================================
+// =================================
+// Surround Panner
+
+/*!
+ @class SurroundPanner
+ @abstract per speaker gains for sources placed around the listener
+ @discussion a source position is x from -1 left to 1 right and y from -1 behind to 1 in front.
+             The direction picks the pair of neighbouring speakers either side of it and the
+             gains of the pair are worked out by vector base amplitude panning and normalised to
+             constant power, these are worked out for every degree when the layout is set so
+             finding the gains is a table look up. Positions inside the circle spread towards
+             every speaker equally, the centre of the room is all speakers at the same gain. The
+             LFE channel is never panned to. Mono and stereo outputs use the sources own pan
+             law and do not use the panner
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class SurroundPanner
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    SurroundPanner();
+    /** Destructor*/
+    ~SurroundPanner();
+    //==============================================================================
+
+    //Most output channels, 7.1
+    static constexpr int maxChannels = 8;
+
+    //Number of sources that have a depth
+    static constexpr int maxSources = 4;
+
+    //Number of directions in the gain table, one every degree
+    static constexpr int tableSize = 360;
+
+    /**
+     * Sets the speakers from the output layout and builds the gain table, not for the audio thread
+     *
+     * @param layout is the layout of the output bus
+     *
+    */
+    void setLayout(const AudioChannelSet& layout);
+
+    /**
+     * Gets the number of speakers sources are panned to, the output channels other than the LFE
+     *
+     * @return the number of speakers
+     *
+    */
+    int getNumSpeakers() const { return numSpeakers; }
+
+    /**
+     * Gets the output channel of a speaker
+     *
+     * @param speaker is the speaker from 0 -> getNumSpeakers
+     *
+     * @return the index of the speakers channel in the output bus
+     *
+    */
+    int getSpeakerChannel(int speaker) const { return speakerChannels[speaker]; }
+
+    /**
+     * Sets how far in front or behind the listener a source is
+     *
+     * @param source is the source from 0 -> maxSources
+     * @param depth is the y position from -1 behind to 1 in front
+     *
+    */
+    void setSourceDepth(int source, float depth);
+
+    /**
+     * Gets the speaker gains for a source at a pan position and its depth
+     *
+     * @param source is the source from 0 -> maxSources
+     * @param pan is the x position from -1 left to 1 right
+     * @param gains returns a gain for each speaker
+     *
+    */
+    void getSourceGains(int source, float pan, float* gains) const;
+
+    /**
+     * Gets the speaker gains for a position
+     *
+     * @param x is the position from -1 left to 1 right
+     * @param y is the position from -1 behind to 1 in front
+     * @param gains returns a gain for each speaker, the squares of the gains add up to 1
+     *
+    */
+    void getGains(float x, float y, float* gains) const;
+
+private:
+
+    /**
+     * Gets the direction of a speaker
+     *
+     * @param type is the type of the speakers channel
+     * @param hasCentre is true if the layout has a centre speaker, the front speakers of layouts
+     *                  with no centre are spread wider
+     *
+     * @return the direction in degrees clockwise from in front, or a value below -180 for channels that are not panned to
+     *
+    */
+    static float getSpeakerAzimuth(AudioChannelSet::ChannelType type, bool hasCentre);
+
+    //Speakers, their output channels and directions in radians sorted clockwise from behind
+    int numSpeakers = 0;
+    int speakerChannels[maxChannels] = {};
+    float speakerAzimuths[maxChannels] = {};
+
+    //Gains of each speaker for each direction from behind going clockwise, the last row repeats the first
+    float gainTable[tableSize + 1][maxChannels] = {};
+
+    //Depth of each source
+    float sourceDepths[maxSources] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    //Pi to be used in calculations
+    static constexpr double PI = 3.14159265358979;
+
+    JUCE_DECLARE_NON_COPYABLE (SurroundPanner)
+};
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    SynthLFO.cpp
+    Low frequency oscillator that renders a block of values at a time, used
+    both for LFOs shared by all voices and LFOs owned by a single voice
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "SynthLFO.h"
+
+SynthLFO::SynthLFO()
+{
+    setSampleRate(sampleRate);  //Setting intial phase delta
+    nextRandomValue();          //Setting intial random values
+}
+
+SynthLFO::~SynthLFO(){}
+
+void SynthLFO::setSampleRate(float newSampleRate)
+{
+    sampleRate = newSampleRate > 0 ? newSampleRate : 48000; //Check passed sample rate bigger than zero if not set as default value
+    phaseDelta = frequency / sampleRate;    //No ramp needed when the sample rate changes
+}
+
+void SynthLFO::setFrequency(float newFrequency)
+{
+    frequency = newFrequency > 0 ? newFrequency : 0.001f;   //Frequency must be positive
+}
+
+void SynthLFO::setShape(int newShape)
+{
+    shape = (newShape < sineShape || newShape > smoothRandomShape) ? (int) sineShape : newShape;    //If out of range set to default shape
+}
+
+void SynthLFO::resetPhase()
+{
+    phasePos = 0.0f;
+}
+
+void SynthLFO::nextRandomValue()
+{
+    prevRandom = currentRandom;
+    currentRandom = randomGen.nextFloat() * 2.0f - 1.0f;
+}
+
+void SynthLFO::renderBlock(float* output, int numSamples)
+{
+    if(numSamples <= 0)
+        return;
+
+    //Ramp the phase delta to the new frequency over the block
+    const float targetDelta = frequency / sampleRate;
+    const float deltaIncrement = (targetDelta - phaseDelta) / numSamples;
+
+    //The shape is picked once per block so each loop only does the work of one shape
+    switch(shape)
+    {
+        case triangleShape:
+            for(int i = 0; i < numSamples; ++i)
+            {
+                output[i] = 4.0f * (std::abs(phasePos - 0.5f) - 0.25f);
+                phaseDelta += deltaIncrement;
+                advancePhase();
+            }
+            break;
+
+        case sawShape:
+            for(int i = 0; i < numSamples; ++i)
+            {
+                output[i] = 2.0f * phasePos - 1.0f;
+                phaseDelta += deltaIncrement;
+                advancePhase();
+            }
+            break;
+
+        case squareShape:
+            for(int i = 0; i < numSamples; ++i)
+            {
+                output[i] = phasePos < 0.5f ? 1.0f : -1.0f;
+                phaseDelta += deltaIncrement;
+                advancePhase();
+            }
+            break;
+
+        case sampleAndHoldShape:    //Hold a new random value each cycle
+            for(int i = 0; i < numSamples; ++i)
+            {
+                output[i] = currentRandom;
+                phaseDelta += deltaIncrement;
+                if(advancePhase())
+                    nextRandomValue();
+            }
+            break;
+
+        case smoothRandomShape:     //Glide from the last random value to the next over each cycle
+            for(int i = 0; i < numSamples; ++i)
+            {
+                const float smoothPhase = phasePos * phasePos * (3.0f - 2.0f * phasePos);
+                output[i] = prevRandom + (currentRandom - prevRandom) * smoothPhase;
+                phaseDelta += deltaIncrement;
+                if(advancePhase())
+                    nextRandomValue();
+            }
+            break;
+
+        case sineShape:
+        default:
+            for(int i = 0; i < numSamples; ++i)
+            {
+                output[i] = std::sin(MathConstants<float>::twoPi * phasePos);
+                phaseDelta += deltaIncrement;
+                advancePhase();
+            }
+            break;
+    }
+
+    phaseDelta = targetDelta;   //Remove any rounding left from the ramp
+}
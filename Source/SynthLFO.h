@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    SynthLFO.h
+    Low frequency oscillator that renders a block of values at a time, used
+    both for LFOs shared by all voices and LFOs owned by a single voice
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+
+// =================================
+// =================================
+// Synth LFO
+
+/*!
+ @class SynthLFO
+ @abstract a block based low frequency oscillator with a choice of shapes
+ @discussion rendered once per block by the processor for global LFOs and by
+             each voice for per voice LFOs
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class SynthLFO
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    SynthLFO();
+    /** Destructor*/
+    ~SynthLFO();
+    //==============================================================================
+
+    //Shapes the LFO can output, matches the order of the lfo shape parameter choices
+    enum Shape
+    {
+        sineShape = 0,
+        triangleShape,
+        sawShape,
+        squareShape,
+        sampleAndHoldShape,
+        smoothRandomShape
+    };
+
+    /**
+     * Sets the sample rate of the LFO
+     *
+     * @param newSampleRate is the sample rate in samples / s
+     *
+    */
+    void setSampleRate(float newSampleRate);
+
+    /**
+     * Sets the frequency of the LFO, the change is ramped over the next rendered block
+     *
+     * @param newFrequency is the frequency in Hz
+     *
+    */
+    void setFrequency(float newFrequency);
+
+    /**
+     * Sets the shape of the LFO
+     *
+     * @param newShape is one of the values in Shape
+     *
+    */
+    void setShape(int newShape);
+
+    /**
+     * Resets the phase of the LFO to the start of its cycle
+     *
+    */
+    void resetPhase();
+
+    /**
+     * Renders a block of LFO values between -1 and 1
+     *
+     * @param output is the array to write numSamples values to
+     * @param numSamples is the number of samples to render
+     *
+    */
+    void renderBlock(float* output, int numSamples);
+
+private:
+
+    /**
+     * Advances the phase by one sample
+     *
+     * @return true if the phase wrapped round to the start of a new cycle
+     *
+    */
+    inline bool advancePhase()
+    {
+        phasePos += phaseDelta;
+        if(phasePos >= 1.0f)    //Wrap phase back to the start of the cycle
+        {
+            phasePos -= 1.0f;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Picks the next random value when a random shape starts a new cycle
+     *
+    */
+    void nextRandomValue();
+
+    int shape = sineShape;          //The shape of the LFO
+    float frequency = 10.0f;        //Frequency of the LFO in Hz
+    float sampleRate = 48000.0f;    //SampleRate of the LFO
+    float phasePos = 0.0f;          //Current position in the cycle from 0 -> 1
+    float phaseDelta = 0.0f;        //Amount the phase changes per sample
+
+    //Random values for the sample and hold and smooth random shapes
+    Random randomGen;
+    float prevRandom = 0.0f;
+    float currentRandom = 0.0f;
+};
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    VoiceArena.cpp
+    One block of cache line aligned memory that all the voices of a
+    processor are built in, one after the other
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "VoiceArena.h"
+
+VoiceArena::VoiceArena(){}
+
+VoiceArena::~VoiceArena(){}
+
+void VoiceArena::reserve(size_t bytes)
+{
+    jassert(start == nullptr);  //Moving the block would leave everything built in it behind
+
+    capacity = alignedSize(bytes);
+    memory.calloc(capacity + alignment);    //Extra line so the start can be moved up to a cache line
+
+    const size_t offset = (alignment - ((size_t) memory.getData() & (alignment - 1))) & (alignment - 1);
+    start = memory.getData() + offset;
+}
+
+void* VoiceArena::allocate(size_t bytes)
+{
+    const size_t size = alignedSize(bytes);
+    jassert(start != nullptr && used + size <= capacity);   //Reserve enough for every voice up front
+
+    void* space = start + used;
+    used += size;
+    return space;
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    VoiceArena.h
+    One block of cache line aligned memory that all the voices of a
+    processor are built in, one after the other
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+
+// =================================
+// =================================
+// Voice Arena
+
+/*!
+ @class VoiceArena
+ @abstract a bump allocator for the voices of one processor
+ @discussion the memory for every voice is reserved at once and each voice is placed at the next
+             cache line in the block, so the voice pool is one contiguous run of memory and no
+             two voices share a cache line. Nothing is freed until the arena is destroyed, the
+             arena must outlive everything built in it
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class VoiceArena
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    VoiceArena();
+    /** Destructor*/
+    ~VoiceArena();
+    //==============================================================================
+
+    //Every allocation starts on its own cache line
+    static constexpr size_t alignment = 64;
+
+    /**
+     * Rounds a size up to a whole number of cache lines
+     *
+     * @param bytes is the size in bytes
+     *
+     * @return the space an allocation of that size takes in the arena
+     *
+    */
+    static constexpr size_t alignedSize(size_t bytes) { return (bytes + alignment - 1) & ~(alignment - 1); }
+
+    /**
+     * Allocates the block, can only be called once and before anything is allocated
+     *
+     * @param bytes is the size of the block, use alignedSize for each object to be built in it
+     *
+    */
+    void reserve(size_t bytes);
+
+    /**
+     * Takes the next aligned space from the block
+     *
+     * @param bytes is the size of the space
+     *
+     * @return a pointer to the space, the arena must have been reserved with room for it
+     *
+    */
+    void* allocate(size_t bytes);
+
+    /**
+     * Gets how much of the block is used
+     *
+     * @return the bytes used including the padding to each cache line
+     *
+    */
+    size_t getBytesUsed() const { return used; }
+
+private:
+    //The block and its start rounded up to a cache line
+    HeapBlock<char> memory;
+    char* start = nullptr;
+
+    //Size of the block from start and the bytes taken from it
+    size_t capacity = 0;
+    size_t used = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (VoiceArena)
+};
@@ -0,0 +1,335 @@
+/*
+  ==============================================================================
+
+    VoiceFilterBank.cpp
+    The butterworth filters of every voice held side by side so that the
+    filters of all the voices are processed together, a group of lanes at a time
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "VoiceFilterBank.h"
+
+VoiceFilterBank::VoiceFilterBank(){}
+
+VoiceFilterBank::~VoiceFilterBank(){}
+
+void VoiceFilterBank::prepare(float sampleRate, int newNumVoices, int numChannels)
+{
+    sampleRate = sampleRate > 0 ? sampleRate : 48000;   //Check passed sample rate bigger than zero if not set as default value
+    sampleTime = 1.0 / sampleRate;
+    coeffTable = IIRCoeffTable::getTable(sampleRate);
+
+    //A lane for each channel of each voice, rounded up to a power of 2 so a voices lanes never cross
+    //bettween groups, and to whole groups so the unused lanes at the end can be processed with the rest
+    numVoices = jmax(0, newNumVoices);
+    channelsPerVoice = jlimit(1, maxChannels, numChannels);
+    lanesPerVoice = 1;
+    while(lanesPerVoice < channelsPerVoice)
+        lanesPerVoice *= 2;
+    numGroups = (numVoices * lanesPerVoice + laneGroupSize - 1) / laneGroupSize;
+    numLanes = numGroups * laneGroupSize;
+
+    coeffs.calloc(numStages * 5 * numLanes);
+    increments.calloc(numStages * 5 * numLanes);
+    endCoeffs.calloc(numStages * 5 * numLanes);
+    rampLengths.calloc(numLanes);
+    state.calloc(numStages * 2 * numLanes);
+    laneSamples.calloc(maxBlockSize * numLanes);
+    voiceModes.calloc(numVoices * numFilters);
+    voiceSubmitted.calloc(numVoices);
+    voiceRamping.calloc(numVoices * numStages);
+    stageUsed.calloc(numGroups * numStages);
+    stageRamping.calloc(numGroups * numStages);
+
+    for(int stage = 0; stage < numStages; ++stage)  //Every lane starts as a pass through
+    {
+        for(int lane = 0; lane < numLanes; ++lane)
+        {
+            coeffs[laneIndex(stage, 0, 5, lane)] = 1.0;
+            endCoeffs[laneIndex(stage, 0, 5, lane)] = 1.0;
+        }
+    }
+}
+
+void VoiceFilterBank::calcFilterCoeffs(int filterNum, int filterMode, float cutoff, double (*filterCoeffs)[5]) const
+{
+    const bool highPass = filterNum == 1;
+    const bool minus24DbMode = filterMode == 2;
+
+    //Use the table if the cut off is in its range
+    if(coeffTable != nullptr && coeffTable -> lookupCoeffs(cutoff, highPass, minus24DbMode, filterCoeffs))
+        return;
+
+    double wp = 2 * tan(cutoff * PI * sampleTime);  //Calculate freuqncy warped cut-off so bilinear transform can be used
+
+    if(minus24DbMode)   //If in -24Db/Octave mode use two sections, the more damped one first
+    {
+        IIRCoeffTable::calcSectionCoeffs(wp, highPass, IIRCoeffTable::dampingCoeffs[1], filterCoeffs[0]);
+        IIRCoeffTable::calcSectionCoeffs(wp, highPass, IIRCoeffTable::dampingCoeffs[2], filterCoeffs[1]);
+    }
+    else    //Otherwise one 2nd order section
+    {
+        IIRCoeffTable::calcSectionCoeffs(wp, highPass, IIRCoeffTable::dampingCoeffs[0], filterCoeffs[0]);
+    }
+}
+
+void VoiceFilterBank::submitVoice(int voice, const float* const* channels, int numSamples, const int* filterModes, const float* endCutoffs, bool resetState)
+{
+    jassert(voice >= 0 && voice < numVoices && numSamples <= maxBlockSize);
+    const int firstLane = voice * lanesPerVoice;
+
+    for(int i = 0; i < numSamples; ++i)     //Writing the block into the voices lanes
+    {
+        for(int chan = 0; chan < channelsPerVoice; ++chan)
+            laneSamples[i * numLanes + firstLane + chan] = channels[chan][i];
+    }
+    
+    for(int i = numSamples; i < maxBlockSize; ++i)  //A voice that stopped early leaves silence rather than the last blocks samples
+    {
+        for(int chan = 0; chan < channelsPerVoice; ++chan)
+            laneSamples[i * numLanes + firstLane + chan] = 0.0f;
+    }
+    
+    for(int lane = firstLane; lane < firstLane + lanesPerVoice; ++lane)
+        rampLengths[lane] = numSamples;
+
+    for(int f = 0; f < numFilters; ++f)
+    {
+        //Unused sections pass the samples straight through
+        double target[maxSections][5] = {{1.0, 0.0, 0.0, 0.0, 0.0}, {1.0, 0.0, 0.0, 0.0, 0.0}};
+        const int mode = filterModes[f];
+        if(mode != 0)
+            calcFilterCoeffs(f, mode, endCutoffs[f], target);
+
+        //A mode change jumps straight to the new coefficients rather than interpolating bettween different filters,
+        //as does a cleared state as it has no old coefficients to carry on from
+        const int oldMode = voiceModes[voice * numFilters + f];
+        const bool modeChanged = mode != oldMode;
+        const bool jumpCoeffs = modeChanged || resetState;
+        voiceModes[voice * numFilters + f] = mode;
+
+        for(int s = 0; s < maxSections; ++s)
+        {
+            const int stage = f * maxSections + s;
+            const bool switchedIn = s >= oldMode && s < mode;   //Sections being switched in start from a clear state, the mode is the number of sections
+            bool ramping = false;
+
+            for(int lane = firstLane; lane < firstLane + lanesPerVoice; ++lane)
+            {
+                for(int c = 0; c < 5; ++c)
+                {
+                    const int index = laneIndex(stage, c, 5, lane);
+                    endCoeffs[index] = target[s][c];
+                    if(jumpCoeffs)
+                    {
+                        coeffs[index] = target[s][c];
+                        increments[index] = 0.0;
+                    }
+                    else
+                    {
+                        increments[index] = (target[s][c] - coeffs[index]) / numSamples;
+                        ramping = ramping || increments[index] != 0.0;
+                    }
+                }
+
+                if(resetState || switchedIn)
+                {
+                    state[laneIndex(stage, 0, 2, lane)] = 0.0;
+                    state[laneIndex(stage, 1, 2, lane)] = 0.0;
+                }
+            }
+            voiceRamping[voice * numStages + stage] = ramping;
+        }
+    }
+
+    voiceSubmitted[voice] = true;
+}
+
+void VoiceFilterBank::process(int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    const int voicesPerGroup = laneGroupSize / lanesPerVoice;
+
+    for(int g = 0; g < numGroups; ++g)
+    {
+        const int firstVoice = g * voicesPerGroup;
+        const int endVoice = jmin(firstVoice + voicesPerGroup, numVoices);
+
+        bool groupActive = false;   //Groups with no voices playing are skipped
+        for(int v = firstVoice; v < endVoice; ++v)
+            groupActive = groupActive || voiceSubmitted[v];
+
+        if(!groupActive)
+            continue;
+
+        for(int s = 0; s < numStages; ++s)
+        {
+            stageUsed[g * numStages + s] = false;
+            stageRamping[g * numStages + s] = false;
+        }
+
+        for(int v = firstVoice; v < endVoice; ++v)
+        {
+            if(!voiceSubmitted[v])  //Voices that have stopped let their filter tails decay with no input and fixed coefficients
+            {
+                for(int lane = v * lanesPerVoice; lane < (v + 1) * lanesPerVoice; ++lane)
+                {
+                    for(int i = 0; i < numSamples; ++i)
+                        laneSamples[i * numLanes + lane] = 0.0f;
+                    
+                    for(int stage = 0; stage < numStages; ++stage)
+                    {
+                        for(int c = 0; c < 5; ++c)
+                            increments[laneIndex(stage, c, 5, lane)] = 0.0;
+                    }
+                }
+            }
+
+            for(int f = 0; f < numFilters; ++f) //A stage is run for the group if any voice in it uses the section
+            {
+                const int mode = voiceModes[v * numFilters + f];
+                for(int s = 0; s < mode && s < maxSections; ++s)
+                {
+                    const int stage = f * maxSections + s;
+                    stageUsed[g * numStages + stage] = true;
+                    stageRamping[g * numStages + stage] = stageRamping[g * numStages + stage] || (voiceSubmitted[v] && voiceRamping[v * numStages + stage]);
+                }
+            }
+        }
+
+        processGroup(g, numSamples);
+
+        for(int stage = 0; stage < numStages; ++stage)  //Finishing the block on the exact end coefficients
+        {
+            for(int c = 0; c < 5; ++c)
+            {
+                for(int lane = g * laneGroupSize; lane < (g + 1) * laneGroupSize; ++lane)
+                    coeffs[laneIndex(stage, c, 5, lane)] = endCoeffs[laneIndex(stage, c, 5, lane)];
+            }
+        }
+    }
+
+    for(int v = 0; v < numVoices; ++v)
+        voiceSubmitted[v] = false;
+}
+
+void VoiceFilterBank::processGroup(int group, int numSamples)
+{
+    const int firstLane = group * laneGroupSize;
+
+    //The group is filtered in doubles like the voice filters, the stages are in series so each
+    //one filters the whole block before the next, keeping one stages values in locals at a time
+    alignas(64) double work[maxBlockSize][laneGroupSize];
+    for(int i = 0; i < numSamples; ++i)
+    {
+        for(int l = 0; l < laneGroupSize; ++l)
+            work[i][l] = laneSamples[i * numLanes + firstLane + l];
+    }
+
+    for(int stage = 0; stage < numStages; ++stage)
+    {
+        if(!stageUsed[group * numStages + stage])
+            continue;
+
+        alignas(64) double c[5][laneGroupSize];
+        alignas(64) double inc[5][laneGroupSize];
+        alignas(64) double rampEnd[laneGroupSize];
+        alignas(64) double s1[laneGroupSize];
+        alignas(64) double s2[laneGroupSize];
+
+        for(int k = 0; k < 5; ++k)
+        {
+            for(int l = 0; l < laneGroupSize; ++l)
+            {
+                c[k][l] = coeffs[laneIndex(stage, k, 5, firstLane + l)];
+                inc[k][l] = increments[laneIndex(stage, k, 5, firstLane + l)];
+            }
+        }
+        for(int l = 0; l < laneGroupSize; ++l)
+        {
+            rampEnd[l] = rampLengths[firstLane + l];
+            s1[l] = state[laneIndex(stage, 0, 2, firstLane + l)];
+            s2[l] = state[laneIndex(stage, 1, 2, firstLane + l)];
+        }
+
+        if(stageRamping[group * numStages + stage])
+        {
+            for(int i = 0; i < numSamples; ++i)
+            {
+                //Coefficients are worked out from the start of the block so there is no chain of additions bettween samples
+                const double steps = i + 1;
+
+                //Fixed trip count over the lanes of the group so every line is one vector operation, lanes
+                //of voices that stopped early hold their end coefficients rather than ramping past them
+                for(int l = 0; l < laneGroupSize; ++l)
+                {
+                    const double laneSteps = std::min(steps, rampEnd[l]);
+                    const double b0 = c[0][l] + inc[0][l] * laneSteps;
+                    const double b1 = c[1][l] + inc[1][l] * laneSteps;
+                    const double b2 = c[2][l] + inc[2][l] * laneSteps;
+                    const double a1 = c[3][l] + inc[3][l] * laneSteps;
+                    const double a2 = c[4][l] + inc[4][l] * laneSteps;
+
+                    const double x = work[i][l];
+                    const double y = b0 * x + s1[l];
+                    s1[l] = b1 * x - a1 * y + s2[l];
+                    s2[l] = b2 * x - a2 * y;
+                    work[i][l] = y;
+                }
+            }
+        }
+        else    //No lane in the group is changing its cut off so the coefficients stay the same for the block
+        {
+            for(int i = 0; i < numSamples; ++i)
+            {
+                for(int l = 0; l < laneGroupSize; ++l)
+                {
+                    const double x = work[i][l];
+                    const double y = c[0][l] * x + s1[l];
+                    s1[l] = c[1][l] * x - c[3][l] * y + s2[l];
+                    s2[l] = c[2][l] * x - c[4][l] * y;
+                    work[i][l] = y;
+                }
+            }
+        }
+
+        for(int l = 0; l < laneGroupSize; ++l)  //Storing the states for the next block, flushing states too small to hear
+        {
+            state[laneIndex(stage, 0, 2, firstLane + l)] = Denormals::flush(s1[l]);
+            state[laneIndex(stage, 1, 2, firstLane + l)] = Denormals::flush(s2[l]);
+        }
+    }
+
+    for(int i = 0; i < numSamples; ++i)
+    {
+        for(int l = 0; l < laneGroupSize; ++l)
+            laneSamples[i * numLanes + firstLane + l] = (float) work[i][l];
+    }
+}
+
+void VoiceFilterBank::readVoice(int voice, float* const* channels, int numSamples) const
+{
+    const int firstLane = voice * lanesPerVoice;
+    for(int i = 0; i < numSamples; ++i)
+    {
+        for(int chan = 0; chan < channelsPerVoice; ++chan)
+            channels[chan][i] = laneSamples[i * numLanes + firstLane + chan];
+    }
+}
+
+bool VoiceFilterBank::voiceSilent(int voice, double level) const
+{
+    const int firstLane = voice * lanesPerVoice;
+    for(int stage = 0; stage < numStages; ++stage)
+    {
+        for(int lane = firstLane; lane < firstLane + lanesPerVoice; ++lane)
+        {
+            if(std::abs(state[laneIndex(stage, 0, 2, lane)]) >= level || std::abs(state[laneIndex(stage, 1, 2, lane)]) >= level)
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    VoiceFilterBank.h
+    The butterworth filters of every voice held side by side so that the
+    filters of all the voices are processed together, a group of lanes at a time
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+#include "MyIIRFilter.h"
+
+// =================================
+// =================================
+// Voice Filter Bank
+
+/*!
+ @class VoiceFilterBank
+ @abstract the low pass and high pass filters of all the voices in structure of arrays form
+ @discussion each voice channel is a lane and every stage of the filters, 2 sections for each
+             of the 2 filters, keeps its transposed direct form II states and coefficients in
+             arrays indexed by lane. A block is filtered one sample at a time across a group of
+             laneGroupSize lanes so the inner loop has a fixed trip count and maps onto vector
+             registers, and the cost grows with the number of groups rather than filters.
+             Voices hand in their block and the cut off they end the block on, the coefficients
+             are interpolated across the block from where the last block finished. Mono voices
+             take one lane each so twice as many fit in a group, surround voices take a lane for
+             each channel rounded up to a power of 2
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class VoiceFilterBank
+{
+public:
+    //==============================================================================
+    /** Constructor*/
+    VoiceFilterBank();
+    /** Destructor*/
+    ~VoiceFilterBank();
+    //==============================================================================
+
+    //Number of lanes processed together, 16 doubles fill two AVX-512 or four AVX2 registers which
+    //gives enough independent recursions per sample to hide the latency of each filter stage
+    static constexpr int laneGroupSize = 16;
+
+    //Most samples in a block, matches the voices block size
+    static constexpr int maxBlockSize = 32;
+
+    //Most channels of each voice, enough for a 7.1 output
+    static constexpr int maxChannels = 8;
+    static_assert(laneGroupSize % maxChannels == 0, "Every voices lanes have to fit inside one group");
+
+    //Filters of each voice and the most 2nd order sections each filter uses
+    static constexpr int numFilters = 2;
+    static constexpr int maxSections = 2;
+
+    /**
+     * Allocates the lanes for a number of voices and sets the sample rate, not for the audio thread
+     *
+     * @param sampleRate is the sample rate in samples / s
+     * @param newNumVoices is the number of voices using the bank
+     * @param numChannels is the number of channels each voice renders from 1 -> maxChannels
+     *
+    */
+    void prepare(float sampleRate, int newNumVoices, int numChannels);
+
+    /**
+     * Hands a voices block to the bank to be filtered by the next call to process. A voice that
+     * stopped part way through the block hands in fewer samples than the bank processes, the rest
+     * of its lanes are filled with silence and its coefficients hold at the end coefficients
+     *
+     * @param voice is the index of the voice
+     * @param channels is an array of a channel pointer for each channel the bank was prepared with, each holding numSamples samples
+     * @param numSamples is the number of samples in the voices block
+     * @param filterModes is the mode of each filter, 0 off, 1 -12dB/oct and 2 -24dB/oct
+     * @param endCutoffs is the cut off in Hz of each filter at the end of the block
+     * @param resetState true to clear the voices filter states before filtering, the coefficients start at the end coefficients
+     *
+    */
+    void submitVoice(int voice, const float* const* channels, int numSamples, const int* filterModes, const float* endCutoffs, bool resetState);
+
+    /**
+     * Filters every lane group that has a voice submitted this block
+     *
+     * @param numSamples is the number of samples in the block
+     *
+    */
+    void process(int numSamples);
+
+    /**
+     * Copies a voices filtered block back out of the bank
+     *
+     * @param voice is the index of the voice
+     * @param channels is an array of a channel pointer for each channel the bank was prepared with, each holding numSamples samples
+     * @param numSamples is the number of samples to copy
+     *
+    */
+    void readVoice(int voice, float* const* channels, int numSamples) const;
+    
+    /**
+     * Checks if a voices filters have no tail left to output
+     *
+     * @param voice is the index of the voice
+     * @param level is the level below which a state counts as silent
+     *
+     * @return true if every state in the voices lanes is smaller than level
+     *
+    */
+    bool voiceSilent(int voice, double level) const;
+
+private:
+
+    /**
+     * Filters one group of lanes
+     *
+     * @param group is the lane group to filter
+     * @param numSamples is the number of samples in the block
+     *
+    */
+    void processGroup(int group, int numSamples);
+
+    /**
+     * Calculates the coefficients of a filters sections at a cut off
+     *
+     * @param filterNum is the filter, 0 is low pass and 1 is high pass
+     * @param filterMode is 1 for -12dB/oct and 2 for -24dB/oct
+     * @param cutoff is the cut off in Hz
+     * @param coeffs returns the coefficients of each section
+     *
+    */
+    void calcFilterCoeffs(int filterNum, int filterMode, float cutoff, double (*coeffs)[5]) const;
+
+    /**
+     * Gets the index of a value in a per lane array with numValues values per stage
+     *
+    */
+    inline int laneIndex(int stage, int value, int numValues, int lane) const
+    {
+        return (stage * numValues + value) * numLanes + lane;
+    }
+
+    //Each filter section is a stage, stage = filter * maxSections + section
+    static constexpr int numStages = numFilters * maxSections;
+
+    //Number of voices, channels and lanes for each voice and lanes, the lanes are rounded up to whole groups
+    int numVoices = 0;
+    int channelsPerVoice = 2;
+    int lanesPerVoice = 2;
+    int numLanes = 0;
+    int numGroups = 0;
+
+    //Coefficients, their per sample increments and the coefficients at the end of the block, all as [stage][coefficient][lane]
+    HeapBlock<double> coeffs;
+    HeapBlock<double> increments;
+    HeapBlock<double> endCoeffs;
+    
+    //Number of samples each lanes coefficients ramp over before holding at the end coefficients
+    HeapBlock<double> rampLengths;
+
+    //Transposed direct form II states as [stage][state][lane]
+    HeapBlock<double> state;
+
+    //Input and output samples of every lane as [sample][lane]
+    HeapBlock<float> laneSamples;
+
+    //Mode of each voices filters, if each voice was submitted this block and which of its stages have moving coefficients
+    HeapBlock<int> voiceModes;
+    HeapBlock<bool> voiceSubmitted;
+    HeapBlock<bool> voiceRamping;
+    
+    //Which stages each group uses and which of those have any lane with moving coefficients
+    HeapBlock<bool> stageUsed;
+    HeapBlock<bool> stageRamping;
+
+    //Shared coefficient table for the sample rate and the sample time in s
+    std::shared_ptr<const IIRCoeffTable> coeffTable;
+    double sampleTime = 1.0/48000;
+    double PI = 3.14159265358979;
+};
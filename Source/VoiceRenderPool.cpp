@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.cpp
+    A pool of worker threads shared by every synth in the process that audio
+    threads hand jobs to and help with, waiting for their jobs to finish
+    before they carry on
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "VoiceRenderPool.h"
+#include <mutex>
+
+VoiceRenderPool::VoiceRenderPool(int numWorkers)
+{
+    numWorkers = jlimit(0, maxWorkers, numWorkers);
+    numParticipants = numWorkers + 1;   //Set before the workers start reading it
+
+    for(int i = 0; i < numWorkers; ++i)
+    {
+        //Workers run at the audio priority where the system allows it
+        workers.add(new Worker(*this, i)) -> startThread(Thread::realtimeAudioPriority);
+    }
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+    for(auto* worker : workers)
+    {
+        worker -> signalThreadShouldExit();
+        worker -> wakeEvent.signal();
+    }
+    for(auto* worker : workers)
+        worker -> stopThread(1000);
+}
+
+std::shared_ptr<VoiceRenderPool> VoiceRenderPool::getSharedPool()
+{
+    //The pool is kept while any synth uses it so every instance in the process shares the same workers
+    static std::mutex poolLock;
+    static std::weak_ptr<VoiceRenderPool> pool;
+
+    std::lock_guard<std::mutex> lock(poolLock);
+    std::shared_ptr<VoiceRenderPool> sharedPool = pool.lock();
+    if(sharedPool == nullptr)   //Create the pool if no synth is using one
+    {
+        sharedPool = std::make_shared<VoiceRenderPool>(getDefaultNumWorkers());
+        pool = sharedPool;
+    }
+    return sharedPool;
+}
+
+int VoiceRenderPool::getDefaultNumWorkers()
+{
+    return jlimit(0, maxWorkers, SystemStats::getNumPhysicalCpus() - 1);
+}
+
+void VoiceRenderPool::run(JobList& jobs, int numJobs, int64 deadline)
+{
+    if(numJobs <= 0)
+        return;
+
+    //Taking a free slot, if another thread is using every slot the jobs are run here
+    Submission* submission = nullptr;
+    for(int s = 0; s < maxSubmissions && submission == nullptr; ++s)
+    {
+        bool expected = false;
+        if(!submissions[s].inUse.load(std::memory_order_relaxed) && submissions[s].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            submission = &submissions[s];
+    }
+
+    if(submission == nullptr || workers.size() == 0)
+    {
+        for(int j = 0; j < numJobs; ++j)
+            jobs.runJob(j);
+        if(submission != nullptr)
+            submission -> inUse.store(false, std::memory_order_release);
+        return;
+    }
+
+    submission -> jobs.store(&jobs, std::memory_order_relaxed);
+    submission -> jobsDone.store(0, std::memory_order_relaxed);
+    submission -> deadline.store(deadline, std::memory_order_relaxed);
+
+    //Splitting the jobs evenly bettween the ranges, storing a range publishes the jobs to whoever claims from it
+    for(int p = 0; p < numParticipants; ++p)
+    {
+        const uint32 begin = (uint32) (numJobs * p / numParticipants);
+        const uint32 end = (uint32) (numJobs * (p + 1) / numParticipants);
+        submission -> ranges[p].range.store(packRange(begin, end), std::memory_order_release);
+    }
+
+    //Spinning workers see the new generation, sleeping ones are woken until there is one for
+    //each job this thread will not be running, waking more would only take cores from other threads
+    generation.fetch_add(1, std::memory_order_seq_cst);
+    int toWake = numJobs - 1;
+    for(int w = 0; w < workers.size() && toWake > 0; ++w)
+    {
+        Worker* worker = workers.getUnchecked(w);
+        if(worker -> sleeping.load(std::memory_order_seq_cst))
+        {
+            worker -> wakeEvent.signal();
+            --toWake;
+        }
+    }
+
+    //This thread runs its own jobs rather than others so it is never held up by a later deadline, its own
+    //range first and then helping with the ranges of workers that have not got to them yet
+    while(runNextJob(*submission, 0)) {}
+
+    //Every job has been claimed so the workers are finishing their last ones
+    for(int spins = 0; submission -> jobsDone.load(std::memory_order_acquire) < numJobs; ++spins)
+    {
+        if(spins >= spinCount)
+            Thread::yield();
+    }
+
+    submission -> inUse.store(false, std::memory_order_release);
+}
+
+bool VoiceRenderPool::hasJobsLeft(const Submission& submission) const
+{
+    for(int p = 0; p < numParticipants; ++p)
+    {
+        const uint64 current = submission.ranges[p].range.load(std::memory_order_acquire);
+        if(rangeNext(current) < rangeEnd(current))
+            return true;
+    }
+    return false;
+}
+
+bool VoiceRenderPool::runNextJob(Submission& submission, int participant)
+{
+    //Own range first then taking jobs from the others
+    for(int i = 0; i < numParticipants; ++i)
+    {
+        std::atomic<uint64>& range = submission.ranges[(participant + i) % numParticipants].range;
+        uint64 current = range.load(std::memory_order_acquire);
+
+        while(rangeNext(current) < rangeEnd(current))
+        {
+            //Claiming the next job, if another thread got there first current is updated and we try again
+            const uint32 job = rangeNext(current);
+            if(range.compare_exchange_weak(current, packRange(job + 1, rangeEnd(current)), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                submission.jobs.load(std::memory_order_relaxed) -> runJob((int) job);
+                submission.jobsDone.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool VoiceRenderPool::runEarliestJob(int participant)
+{
+    //Earliest deadline first, a submission can finish while we look so claiming it may still fail
+    Submission* earliest = nullptr;
+    int64 earliestDeadline = 0;
+
+    for(auto& submission : submissions)
+    {
+        if(!submission.inUse.load(std::memory_order_relaxed) || !hasJobsLeft(submission))
+            continue;
+
+        const int64 deadline = submission.deadline.load(std::memory_order_relaxed);
+        if(earliest == nullptr || deadline < earliestDeadline)
+        {
+            earliest = &submission;
+            earliestDeadline = deadline;
+        }
+    }
+
+    return earliest != nullptr && runNextJob(*earliest, participant);
+}
+
+//==============================================================================
+
+VoiceRenderPool::Worker::Worker(VoiceRenderPool& owner, int workerIndex)
+    : Thread("Voice Render Worker " + String(workerIndex)), pool(owner), participant(workerIndex + 1)
+{
+}
+
+void VoiceRenderPool::Worker::run()
+{
+    //Same as the audio threads so the voices render the same on every thread
+    ScopedNoDenormals noDenormals;
+
+    uint32 lastGeneration = pool.generation.load(std::memory_order_acquire);
+
+    while(!threadShouldExit())
+    {
+        if(pool.runEarliestJob(participant))
+            continue;
+
+        //Spin for a short time waiting for more jobs
+        uint32 currentGeneration = pool.generation.load(std::memory_order_acquire);
+        for(int spins = 0; currentGeneration == lastGeneration && spins < spinCount; ++spins)
+            currentGeneration = pool.generation.load(std::memory_order_acquire);
+
+        if(currentGeneration == lastGeneration)
+        {
+            //Nothing came so sleep, checking again after saying so in case jobs were submitted in bettween
+            sleeping.store(true, std::memory_order_seq_cst);
+            if(pool.generation.load(std::memory_order_seq_cst) == lastGeneration)
+                wakeEvent.wait(sleepTimeout);
+            sleeping.store(false, std::memory_order_relaxed);
+        }
+
+        lastGeneration = pool.generation.load(std::memory_order_acquire);
+    }
+}
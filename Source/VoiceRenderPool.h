@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    A pool of worker threads shared by every synth in the process that audio
+    threads hand jobs to and help with, waiting for their jobs to finish
+    before they carry on
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//Include juce
+#include <JuceHeader.h>
+#include <memory>   //Including memory for sharing the pool
+
+// =================================
+// =================================
+// Voice Render Pool
+
+/*!
+ @class VoiceRenderPool
+ @abstract worker threads for rendering groups of voices at the same time as the audio threads
+ @discussion one pool is shared by every synth in the process so a session with many instances
+             never has more workers than there are cores. Each call to run takes a submission
+             slot and splits its jobs there into one range for itself and one for each worker,
+             then works through its own range while the workers help. Whoever runs out of jobs
+             in their own range takes them from the other ranges of the submission, the jobs
+             are claimed with a compare and swap on the range so there are no locks or
+             allocations on the audio thread. Every submission has a deadline, the time its
+             audio block is due, and the workers always take jobs from the submission with the
+             earliest deadline. Only as many workers are woken as the jobs can use, the audio
+             thread never waits for a worker to wake as it claims any jobs not taken yet. If
+             every slot is in use the jobs are all run on the calling thread. Workers spin for
+             a short time after running jobs so the next block finds them awake, then sleep
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class VoiceRenderPool
+{
+public:
+    /*!
+     @class VoiceRenderPool::JobList
+     @abstract a set of numbered jobs to run on the pool
+     @discussion runJob is called once for each job number, from any of the threads in the pool,
+                 so jobs must only write to data no other job uses
+     */
+    class JobList
+    {
+    public:
+        virtual ~JobList(){}
+
+        /**
+         * Runs one job
+         *
+         * @param jobIndex is the number of the job from 0 -> the number of jobs passed to run
+         *
+        */
+        virtual void runJob(int jobIndex) = 0;
+    };
+
+    //==============================================================================
+    /**
+     * Constructor, starts the worker threads, not for the audio thread
+     *
+     * @param numWorkers is the number of worker threads from 0 -> maxWorkers, 0 runs every job on the calling thread
+     *
+    */
+    VoiceRenderPool(int numWorkers);
+
+    /** Destructor, stops the worker threads*/
+    ~VoiceRenderPool();
+    //==============================================================================
+
+    //Most worker threads
+    static constexpr int maxWorkers = 15;
+
+    //Most audio threads that can have jobs on the pool at once
+    static constexpr int maxSubmissions = 16;
+
+    /**
+     * Gets the pool shared by the whole process, creating it if no synth is using it, not for the audio thread
+     *
+     * @return the shared pool, it is deleted when the last synth using it lets go
+     *
+    */
+    static std::shared_ptr<VoiceRenderPool> getSharedPool();
+
+    /**
+     * Gets the number of worker threads a machine can use, one less than the number of physical
+     * cores so that an audio thread always has a core and the workers never share one
+     *
+     * @return the number of workers from 0 -> maxWorkers
+     *
+    */
+    static int getDefaultNumWorkers();
+
+    /**
+     * Gets the number of worker threads
+     *
+     * @return the number of workers
+     *
+    */
+    int getNumWorkers() const { return workers.size(); }
+
+    /**
+     * Runs a set of jobs across the calling thread and the workers and waits for them all to finish,
+     * can be called from several threads at once
+     *
+     * @param jobs is the jobs to run
+     * @param numJobs is the number of jobs
+     * @param deadline is when the jobs need to be finished in high resolution ticks, the workers
+     *                 run the jobs with the earliest deadline first
+     *
+    */
+    void run(JobList& jobs, int numJobs, int64 deadline);
+
+private:
+
+    /*!
+     @class VoiceRenderPool::Worker
+     @abstract a thread that runs jobs from the pool when it is woken
+     */
+    class Worker : public Thread
+    {
+    public:
+        Worker(VoiceRenderPool& owner, int workerIndex);
+
+        void run() override;
+
+        //Set while the worker is waiting on wakeEvent
+        std::atomic<bool> sleeping { false };
+        WaitableEvent wakeEvent;
+
+    private:
+        VoiceRenderPool& pool;
+
+        //Range of each submission the worker starts with, the worker index + 1 as the calling thread has the first
+        const int participant;
+    };
+
+    //A share of the jobs of a submission, on its own cache line so claiming jobs from one range
+    //does not slow down the others
+    struct alignas(64) JobRange
+    {
+        //Next job and the end of the range packed together so both are read and swapped at once
+        std::atomic<uint64> range { 0 };
+    };
+
+    //The jobs handed in by one call to run, on its own cache line so the submissions do not slow each other down
+    struct alignas(64) Submission
+    {
+        //Set while a call to run is using the slot
+        std::atomic<bool> inUse { false };
+
+        std::atomic<JobList*> jobs { nullptr };
+        std::atomic<int> jobsDone { 0 };
+        std::atomic<int64> deadline { 0 };
+
+        //One range for the calling thread and one for each worker
+        JobRange ranges[maxWorkers + 1];
+    };
+
+    /**
+     * Checks if a submission has jobs that have not been claimed
+     *
+     * @param submission is the submission to check
+     *
+     * @return true if any of its ranges has jobs left
+     *
+    */
+    bool hasJobsLeft(const Submission& submission) const;
+
+    /**
+     * Claims and runs one job from a submission, from the participants own range if it has any
+     * left and otherwise from the other ranges
+     *
+     * @param submission is the submission to take the job from
+     * @param participant is 0 for the thread calling run and the worker index + 1 for the workers
+     *
+     * @return false if the submission had no jobs left to claim
+     *
+    */
+    bool runNextJob(Submission& submission, int participant);
+
+    /**
+     * Runs one job from the submission with the earliest deadline
+     *
+     * @param participant is the worker index + 1
+     *
+     * @return false if no submission had jobs left to claim
+     *
+    */
+    bool runEarliestJob(int participant);
+
+    //Packing the next job and the end of a range into one value so both can be swapped together
+    static inline uint64 packRange(uint32 next, uint32 end) { return ((uint64) next << 32) | end; }
+    static inline uint32 rangeNext(uint64 range) { return (uint32) (range >> 32); }
+    static inline uint32 rangeEnd(uint64 range) { return (uint32) (range & 0xffffffff); }
+
+    //Number of times a thread checks for work or for the jobs to finish before giving up its time
+    static constexpr int spinCount = 4000;
+
+    //Longest a sleeping worker waits before checking again, in ms
+    static constexpr int sleepTimeout = 100;
+
+    Submission submissions[maxSubmissions];
+
+    //The thread calling run and the workers, the number of ranges the jobs of a submission are split into
+    int numParticipants = 1;
+
+    //Goes up every time jobs are submitted so spinning workers can see there is new work
+    std::atomic<uint32> generation { 0 };
+
+    OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE (VoiceRenderPool)
+};
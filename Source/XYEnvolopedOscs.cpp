@@ -14,11 +14,9 @@
 
 XYEnvolopedOscs::XYEnvolopedOscs()
 {
-    for(int i = 0; i < 4; ++i)      //Creating all synth sources and frequency smoothing parameters
+    for(int i = 0; i < 4; ++i)      //Setting the type of each synth source
     {
-        auto* oscillator = oscs.add(new SynthSources());
-        oscillator -> setType(i);
-        smoothFreq.add(new SmoothChanges());
+        oscs[i].setType(i);
     }
 }
 
@@ -26,11 +24,11 @@ XYEnvolopedOscs::~XYEnvolopedOscs(){}
 
 void XYEnvolopedOscs::setSampleRate(float sampleRate)
 {
-    for(auto* oscillator : oscs) //Set oscillator samplerates
-        oscillator -> setSampleRate(sampleRate);
+    for(auto& oscillator : oscs) //Set oscillator samplerates
+        oscillator.setSampleRate(sampleRate);
     
-    for(auto* smoother : smoothFreq) //Set smoother sample rate
-        smoother -> setSampleRate(sampleRate);
+    for(auto& smoother : smoothFreq) //Set smoother sample rate
+        smoother.setSampleRate(sampleRate);
 }
 
 void XYEnvolopedOscs::setOscsMidiInput(int midiNote)
@@ -51,7 +49,7 @@ void XYEnvolopedOscs::setTuneAmount(int oscNum, int newTuneAmount) //MAY NEED TO
         if(newTuneAmount != targetTuneAmount[oscNum]) //It tune amount changed
         {
             targetTuneAmount[oscNum] = newTuneAmount; //Updated tune amount
-            smoothFreq[oscNum] -> init(MidiMessage::getMidiNoteInHertz(prevMidiInput + tuneAmount[oscNum]), MidiMessage::getMidiNoteInHertz(prevMidiInput + newTuneAmount)); //initslise smoothed freq
+            smoothFreq[oscNum].init(MidiMessage::getMidiNoteInHertz(prevMidiInput + tuneAmount[oscNum]), MidiMessage::getMidiNoteInHertz(prevMidiInput + newTuneAmount)); //initslise smoothed freq
             changeFreq[oscNum] = true;
         }
     }
@@ -65,7 +63,7 @@ void XYEnvolopedOscs::setPanAmount(int oscNum, float newPanAmount)
 
 void XYEnvolopedOscs::setSourceType(int oscNum, int oscType)
 {
-    oscs[oscNum] -> setType(oscType); //Set Source type
+    oscs[oscNum].setType(oscType); //Set Source type
 }
 
 void XYEnvolopedOscs::setOscMinMaxVolume(int oscNum, float minVol, float maxVol)
@@ -96,13 +94,50 @@ void XYEnvolopedOscs::getNextVal(float *envs, float *outSamples)
     {
         int envResult1 = (i % 2);       //Getting which env result to use
         int envResult2 = i < 2 ? 2 : 3;
-        oscSample = (minMaxVols[0][i] + (minMaxVols[1][i] - minMaxVols[0][i]) * envResults[envResult1] * envResults[envResult2]) * oscs[i] ->getNextSample();   //Calculating oscilaltor samples
+        oscSample = (minMaxVols[0][i] + (minMaxVols[1][i] - minMaxVols[0][i]) * envResults[envResult1] * envResults[envResult2]) * oscs[i].getNextSample();   //Calculating oscilaltor samples
         for(int j = 0; j < 2; ++j)
             outSamples[j] = outSamples[j] + oscSample * pan(panAmount[i], j);   //Updating output samples for each channel
     }
 
 }
 
+float XYEnvolopedOscs::getNextMonoVal(float *envs)
+{
+    updateFreq();  //Updating osc frequency
+    
+    float outSample = 0.0f;
+    
+    float envResults[4] = {1 - envs[0], envs[0], 1 - envs[1], envs[1]}; //Possible env results
+    
+    for(int i = 0; i < 4; ++i)  //Get osc samples and adding them to the output sample
+    {
+        int envResult1 = (i % 2);       //Getting which env result to use
+        int envResult2 = i < 2 ? 2 : 3;
+        outSample += (minMaxVols[0][i] + (minMaxVols[1][i] - minMaxVols[0][i]) * envResults[envResult1] * envResults[envResult2]) * oscs[i].getNextSample();
+    }
+    
+    return 0.5f * outSample;    //The two pans of a source add up to 1 so half is the level of a centred source
+}
+
+void XYEnvolopedOscs::getNextSourceVals(float *envs, float *outSamples)
+{
+    updateFreq();  //Updating osc frequency
+    
+    float envResults[4] = {1 - envs[0], envs[0], 1 - envs[1], envs[1]}; //Possible env results
+    
+    for(int i = 0; i < 4; ++i)  //Get osc samples, the panning is left to the caller
+    {
+        int envResult1 = (i % 2);       //Getting which env result to use
+        int envResult2 = i < 2 ? 2 : 3;
+        outSamples[i] = (minMaxVols[0][i] + (minMaxVols[1][i] - minMaxVols[0][i]) * envResults[envResult1] * envResults[envResult2]) * oscs[i].getNextSample();
+    }
+}
+
+float XYEnvolopedOscs::getPanAmount(int oscNum) const
+{
+    return panAmount[oscNum];
+}
+
 float XYEnvolopedOscs::pan(float newPanAmount, int channel)
 {
     float rightPan = (newPanAmount + 1.0f)/2.0f;    //Calculating right pan
@@ -116,9 +151,9 @@ void XYEnvolopedOscs::updateFreq()
     {
         if(changeFreq[i])   //If frequency changing
         {
-            if(smoothFreq[i] -> checkChanging())    //Check smooth value not at target
+            if(smoothFreq[i].checkChanging())    //Check smooth value not at target
             {
-                setOscFrequency(i, smoothFreq[i] -> getNextVal());  //Update osc freq with new freq
+                setOscFrequency(i, smoothFreq[i].getNextVal());  //Update osc freq with new freq
             }
             else
             {
@@ -140,7 +175,7 @@ void XYEnvolopedOscs::playMode(bool playMode)
 
 void XYEnvolopedOscs::setOscFrequency(int oscNum, float frequency)
 {
-    oscs[oscNum] -> setFrequency(frequency);    //Update source frequency
+    oscs[oscNum].setFrequency(frequency);    //Update source frequency
 }
 
 void XYEnvolopedOscs::resetParams()
@@ -149,7 +184,7 @@ void XYEnvolopedOscs::resetParams()
     {
         if(changeFreq[i])   //If their frequency is still changing set frequency to target
         {
-            smoothFreq[i] -> setToTarget();
+            smoothFreq[i].setToTarget();
             tuneAmount[i] = targetTuneAmount[i];
         }
     }
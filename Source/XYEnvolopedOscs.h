@@ -113,6 +113,32 @@ public:
     */
     void getNextVal(float envs[2], float outSamples[2]);
     
+    /**
+     * Gets the next mono value based on envolope values, the sources are not panned
+     *
+     * @param envs is the X Y input to set the oscillator amplitudes
+     *
+     * @return the mono sample at the level of a centred source in each stereo channel
+    */
+    float getNextMonoVal(float envs[2]);
+    
+    /**
+     * Gets the next value of each source based on envolope values, the sources are not panned
+     *
+     * @param envs is the X Y input to set the oscillator amplitudes
+     * @param outSamples is the array to output the sample of each source to
+    */
+    void getNextSourceVals(float envs[2], float outSamples[4]);
+    
+    /**
+     * Gets the oscillator pan amount
+     *
+     * @param oscNum is the number oscillator to get the pan amount of
+     *
+     * @return the pan amount from -1 left to 1 right
+    */
+    float getPanAmount(int oscNum) const;
+    
     /**
      * Sets the systems play mode
      *
@@ -150,7 +176,7 @@ private:
     void resetParams();
     
     //Array of osscilators
-    OwnedArray<SynthSources> oscs;
+    SynthSources oscs[4];
     
     //Array to store min and max volumes of oscillators
     float minMaxVols[2][4]  =  {{0.1f, 0.1f, 0.1f, 0.1f},   //Min Oscillator Volumes
@@ -171,6 +197,6 @@ private:
     bool enableOsc[4] = {true, true, true, true};  //Param for enabling osc
     
     //Smooth frequency object
-    OwnedArray<SmoothChanges> smoothFreq;
+    SmoothChanges smoothFreq[4];
     
 };
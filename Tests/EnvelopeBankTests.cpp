@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    EnvelopeBankTests.cpp
+    Checks the envolope bank against juce::ADSR
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "../Source/EnvelopeBank.h"
+
+// =================================
+// =================================
+// Envelope Bank Tests
+
+/*!
+ @class EnvelopeBankTests
+ @abstract unit tests for the EnvelopeBank
+ @discussion with the curve at 0 every lane of the bank should follow a juce::ADSR with the
+             same parameters, through the attack, decay, sustain and release. The lanes are
+             given different times so the note off lands in a different stage on each lane,
+             including lanes with no attack, no decay or no release
+
+ @namespace none
+ @updated 2026-10-19
+ */
+class EnvelopeBankTests : public UnitTest
+{
+public:
+    EnvelopeBankTests() : UnitTest("Envelope Bank", "PostBoxSynth") {}
+
+    void runTest() override
+    {
+        beginTest("Linear lanes match juce::ADSR sample by sample");
+        compareWithADSR(48000.0f, 8000, false);
+        compareWithADSR(44100.0f, 3000, false);
+
+        beginTest("Linear lanes match juce::ADSR when rendered in blocks");
+        compareWithADSR(48000.0f, 8000, true);
+        compareWithADSR(96000.0f, 1500, true);
+    }
+
+private:
+
+    /**
+     * Runs a note through the bank and a juce::ADSR per lane and checks every sample matches
+     *
+     * @param sampleRate is the sample rate to run at in samples / s
+     * @param noteOffSample is the sample the note is released on
+     * @param useBlocks is true to render with renderBlock and false to use getNextSamples
+     *
+    */
+    void compareWithADSR(float sampleRate, int noteOffSample, bool useBlocks)
+    {
+        const int numLanes = EnvelopeBank::numLanes;
+        const int totalSamples = noteOffSample + (int)(0.2f * sampleRate);
+        const int blockSize = 64;
+
+        EnvelopeBank bank;
+        bank.setSampleRate(sampleRate);
+        ADSR reference[numLanes];
+
+        for(int i = 0; i < numLanes; ++i)
+        {
+            //Spread the times so the note off catches each lane in a different stage
+            ADSR::Parameters params;
+            params.attack = 0.012f * (float)i;
+            params.decay = 0.008f * (float)((i + 3) % numLanes);
+            params.sustain = 0.1f + 0.1f * (float)i;
+            params.release = 0.04f * (float)(i % 3);
+
+            bank.setParameters(i, params);
+            bank.setCurve(i, 0.0f);
+            reference[i].setSampleRate(sampleRate);
+            reference[i].setParameters(params);
+        }
+
+        bank.noteOn();
+        for(auto& adsr : reference)
+            adsr.noteOn();
+
+        std::vector<float> output(blockSize * numLanes);
+        float maxDifference = 0.0f;
+        int sampleNum = 0;
+
+        while(sampleNum < totalSamples)
+        {
+            //Stop blocks at the note off so both sides release on the same sample
+            int numSamples = std::min(blockSize, totalSamples - sampleNum);
+            if(sampleNum < noteOffSample)
+                numSamples = std::min(numSamples, noteOffSample - sampleNum);
+
+            if(useBlocks)
+                bank.renderBlock(output.data(), numSamples);
+            else
+                for(int n = 0; n < numSamples; ++n)
+                    bank.getNextSamples(output.data() + n * numLanes);
+
+            for(int n = 0; n < numSamples; ++n)
+                for(int i = 0; i < numLanes; ++i)
+                    maxDifference = std::max(maxDifference, std::abs(output[n * numLanes + i] - reference[i].getNextSample()));
+
+            sampleNum += numSamples;
+
+            if(sampleNum == noteOffSample)
+            {
+                bank.noteOff();
+                for(auto& adsr : reference)
+                    adsr.noteOff();
+            }
+        }
+
+        expectWithinAbsoluteError(maxDifference, 0.0f, 1.0e-4f, "envolope bank drifted from juce::ADSR");
+
+        //Every lane has finished its release by the end
+        for(int i = 0; i < numLanes; ++i)
+            expect(!bank.isLaneActive(i), "lane still active after its release");
+    }
+};
+
+//Registers the tests with the runner
+static EnvelopeBankTests envelopeBankTests;
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    MyIIRFilterTests.cpp
+    Checks the biquad section MyIIRFilter against the original direct form filter
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+//Include juce
+#include <JuceHeader.h>
+#include "../Source/MyIIRFilter.h"
+
+// =================================
+// =================================
+// Direct Form Reference
+
+/*!
+ @class DirectFormReference
+ @abstract the original single difference equation butterworth filter, kept as a reference
+ @discussion the -12dB/oct and -24dB/oct responses are one 2nd or 4th order difference
+             equation from the bilinear transform, with the division by the output
+             coefficient done every sample, as MyIIRFilter was before it was split into sections
+ @namespace none
+ @updated 2026-10-19
+ */
+class DirectFormReference
+{
+public:
+    /**
+     * Sets up the difference equation
+     *
+     * @param sampleRate is the sample rate in samples / s
+     * @param cutOffFreq is the cut off frequency in Hz
+     * @param minus24DbMode is true for -24dB/oct and false for -12dB/oct
+     * @param highPass is true for high pass and false for low pass
+     *
+    */
+    void setup(float sampleRate, float cutOffFreq, bool minus24DbMode, bool highPass)
+    {
+        const double wp = 2 * tan(cutOffFreq * 3.14159265358979 / sampleRate);    //Frequency warped cut off
+        const double wpSquared = wp * wp;
+        const double wpSquaredp4 = wpSquared + 4;
+        order = minus24DbMode ? 4 : 2;
+        
+        if(minus24DbMode)
+        {
+            const double wps4Squared = wpSquaredp4 * wpSquaredp4;
+            const double b1 = 2 * 0.7654 * wp;
+            const double b2 = 2 * 1.8478 * wp;
+            const double bco = 2 * wpSquared - 8;
+            const double inputCoeffs[5] = {1, 4, 6, 4, 1};
+            const double highPassSigns[5] = {16, -64, 96, -64, 16};
+            
+            for(int i = 0; i < 5; ++i)
+            {
+                inputEqn[i] = highPass ? highPassSigns[i] : inputCoeffs[i] * wpSquared * wpSquared;
+            }
+            
+            outputEqn[0] = -(wps4Squared + b1 * b2) + (b1 + b2) * wpSquaredp4;
+            outputEqn[1] = -bco * 2 * wpSquaredp4 + bco * (b1 + b2);
+            outputEqn[2] = -2 * wps4Squared + 2 * b1 * b2 - bco * bco;
+            outputEqn[3] = -bco * 2 * wpSquaredp4 - bco * (b1 + b2);
+            outputEqn[4] = wps4Squared + b1 * b2 + (b1 + b2) * wpSquaredp4;
+        }
+        else
+        {
+            const double b = 2 * sqrt(2) * wp;
+            inputEqn[0] = highPass ? 4 : wpSquared;
+            inputEqn[1] = highPass ? -8 : 2 * wpSquared;
+            inputEqn[2] = highPass ? 4 : wpSquared;
+            
+            outputEqn[0] = -wpSquaredp4 + b;
+            outputEqn[1] = -2 * wpSquared + 8;
+            outputEqn[2] = wpSquaredp4 + b;
+        }
+    }
+    
+    /**
+     * Filters the next sample
+     *
+     * @param nextSample is the input sample
+     *
+     * @return the filtered sample
+     *
+    */
+    float processNextSample(float nextSample)
+    {
+        //Shifting the previous inputs and outputs along, the newest is at the order position
+        for(int i = 0; i < order; ++i)
+        {
+            prevInput[i] = prevInput[i + 1];
+            prevOutput[i] = prevOutput[i + 1];
+        }
+        prevInput[order] = nextSample;
+        
+        double output = 0;
+        for(int i = 0; i < order + 1; ++i)
+        {
+            output += inputEqn[i] * prevInput[i];
+            if(i < order)
+                output += outputEqn[i] * prevOutput[i];
+        }
+        output = output / outputEqn[order];
+        
+        prevOutput[order] = output;
+        return (float)output;
+    }
+    
+private:
+    int order = 2;
+    double inputEqn[5] = {0, 0, 0, 0, 0};
+    double outputEqn[5] = {0, 0, 0, 0, 1};
+    double prevInput[5] = {0, 0, 0, 0, 0};
+    double prevOutput[5] = {0, 0, 0, 0, 0};
+};
+
+
+// =================================
+// =================================
+// MyIIRFilter Tests
+
+/*!
+ @class MyIIRFilterTests
+ @abstract unit tests for MyIIRFilter
+ @discussion filters the same noise through MyIIRFilter and the original direct form filter for
+             low pass and high pass, -12dB/oct and -24dB/oct, over a spread of cut offs and sample
+             rates, and checks the outputs match to within a fraction of the output peak
+ @namespace none
+ @updated 2026-10-19
+ */
+class MyIIRFilterTests : public UnitTest
+{
+public:
+    MyIIRFilterTests() : UnitTest("MyIIRFilter", "PostBoxSynth") {}
+    
+    void runTest() override
+    {
+        beginTest("Exact coefficients match the direct form filter");
+        compareWithReference(MyIIRFilter::exactCoeffs, 1.0e-4f);
+        
+        beginTest("Table coefficients match the direct form filter");
+        compareWithReference(MyIIRFilter::tableCoeffs, 5.0e-3f);
+    }
+    
+private:
+    
+    /**
+     * Runs noise through both filters for every type, order, cut off and sample rate
+     *
+     * @param coeffMode is the MyIIRFilter coefficient mode to test
+     * @param maxRelativeError is the largest difference allowed as a fraction of the output peak
+     *
+    */
+    void compareWithReference(int coeffMode, float maxRelativeError)
+    {
+        const float sampleRates[3] = {44100.0f, 48000.0f, 96000.0f};
+        const float cutOffs[7] = {30.0f, 80.0f, 200.0f, 1000.0f, 5000.0f, 12000.0f, 19000.0f};
+        const int numSamples = 20000;
+        
+        for(float sampleRate : sampleRates)
+        {
+            for(int highPass = 0; highPass < 2; ++highPass)
+            {
+                for(int minus24Db = 0; minus24Db < 2; ++minus24Db)
+                {
+                    for(float cutOff : cutOffs)
+                    {
+                        MyIIRFilter filter;
+                        filter.setSampleRate(sampleRate);
+                        filter.setCoeffMode(coeffMode);
+                        filter.setFilterParams(cutOff, minus24Db == 1, highPass == 1);
+                        filter.resetFilter();
+                        
+                        DirectFormReference reference;
+                        reference.setup(sampleRate, cutOff, minus24Db == 1, highPass == 1);
+                        
+                        Random noise(1);
+                        float maxDifference = 0.0f;
+                        float peak = 0.0f;
+                        for(int n = 0; n < numSamples; ++n)
+                        {
+                            const float input = noise.nextFloat() * 2.0f - 1.0f;
+                            const float expected = reference.processNextSample(input);
+                            maxDifference = std::max(maxDifference, std::abs(filter.processNextSample(input) - expected));
+                            peak = std::max(peak, std::abs(expected));
+                        }
+                        
+                        expectWithinAbsoluteError(maxDifference / peak, 0.0f, maxRelativeError,
+                                                  String("sample rate ") + String((int)sampleRate) + " cut off " + String((int)cutOff)
+                                                  + (highPass == 1 ? " high pass" : " low pass") + (minus24Db == 1 ? " -24dB/oct" : " -12dB/oct"));
+                    }
+                }
+            }
+        }
+    }
+};
+
+//Registers the tests with the runner
+static MyIIRFilterTests myIIRFilterTests;
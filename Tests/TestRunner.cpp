@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    TestRunner.cpp
+    Runs the PostBoxSynth unit tests
+    Created: 19 Oct 2026
+    Author:  B159113
+
+    Build as a console app with the files in Tests and the files in Source,
+    apart from PluginProcessor.cpp and PluginEditor.cpp, against the same
+    JUCE modules as the plugin. Returns 0 when every test passes
+
+  ==============================================================================
+*/
+
+//Include juce
+#include <JuceHeader.h>
+
+int main()
+{
+    UnitTestRunner runner;
+    runner.runAllTests();
+
+    //Count up the failures so the exit code can be used by scripts
+    int numFailures = 0;
+    for(int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i) -> failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
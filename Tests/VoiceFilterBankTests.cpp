@@ -0,0 +1,297 @@
+/*
+  ==============================================================================
+
+    VoiceFilterBankTests.cpp
+    Checks the filter bank against voices using their own filters
+    Created: 19 Oct 2026
+    Author:  B159113
+
+  ==============================================================================
+*/
+
+#include "../Source/PostBoxSynth.h"
+
+// =================================
+// =================================
+// Voice Filter Bank Tests
+
+/*!
+ @class VoiceFilterBankTests
+ @abstract unit tests for the VoiceFilterBank
+ @discussion two voices are given the same parameters and notes, one is filtered by the bank
+             the way the synthesiser renders and the other runs its own filters. The notes
+             are released so they end part way through a block and a second note is played
+             on the same voices, so any state left in the bank by the first note shows up as
+             a difference. The cut offs only change bettween notes, while a note plays the bank
+             interpolates the coefficients where the voices own filters calculate them each sample.
+
+             A block handed in shorter than the bank processes is also checked against the same
+             samples processed as two blocks, the short block and then silence at the end cut offs
+ @namespace none
+ @updated 2026-10-19
+ */
+class VoiceFilterBankTests : public UnitTest
+{
+public:
+    VoiceFilterBankTests() : UnitTest("Voice Filter Bank", "PostBoxSynth") {}
+
+    void runTest() override
+    {
+        beginTest("-12dB/oct low pass and high pass match the voices own filters");
+        compareWithVoiceFilters(1, 1);
+
+        beginTest("-24dB/oct low pass and -12dB/oct high pass match the voices own filters");
+        compareWithVoiceFilters(2, 1);
+
+        beginTest("Mixed orders with one filter off match the voices own filters");
+        compareWithVoiceFilters(2, 0);
+
+        beginTest("A short block is followed by silence at the end cut offs");
+        compareShortBlock(1, 2);
+        compareShortBlock(2, 1);
+    }
+
+private:
+    /**
+     * Plays two notes on a bank filtered voice and a voice using its own filters and checks they match
+     *
+     * @param lowPassMode is the mode of the low pass filter, 0 off, 1 -12dB/oct and 2 -24dB/oct
+     * @param highPassMode is the mode of the high pass filter, 0 off and 1 -12dB/oct, the others are the voices SVF
+     *
+    */
+    void compareWithVoiceFilters(int lowPassMode, int highPassMode)
+    {
+        const float sampleRate = 48000.0f;
+        const int blockSize = PostBoxSynth::envBlockSize;
+        const int numBlocks = 200;
+        const int filterModes[2] = {lowPassMode, highPassMode};
+
+        VoiceArena arena;
+        arena.reserve(2 * VoiceArena::alignedSize(sizeof(PostBoxSynth)));
+        PostBoxSynth* bankVoice = new (arena) PostBoxSynth();
+        PostBoxSynth* ownVoice = new (arena) PostBoxSynth();
+
+        VoiceFilterBank bank;
+        bank.prepare(sampleRate, 1, 2);
+        bankVoice -> setFilterBank(&bank, 0);
+
+        //Short amplitude release so the notes end part way through a block
+        OwnedArray<EnvolopeParams> envs;
+        OwnedArray<SimpleParams> oscs, lfos, filters, paramEnvs;
+        SimpleParams drive(1, 1);
+        for(int i = 0; i < PostBoxSynth::numEnvs; ++i)
+        {
+            envs.add(new EnvolopeParams());
+            envs[i] -> setParams(2.0f, 50.0f, 70.0f, i == 0 ? 7.0f : 100.0f);
+        }
+        for(int i = 0; i < PostBoxSynth::numSources; ++i)
+        {
+            oscs.add(new SimpleParams(1, 4));
+            int choice[1] = {i + 1};
+            float params[4] = {0.1f * i, i % 2 == 0 ? -0.5f : 0.5f, 0.5f, 1.0f};
+            oscs[i] -> setParams(choice, params);
+        }
+        for(int i = 0; i < PostBoxSynth::numLFOs; ++i)
+            lfos.add(new SimpleParams(2, 2));
+        for(int i = 0; i < PostBoxSynth::numFilters; ++i)
+            filters.add(new SimpleParams(1, 2));
+        for(int i = 0; i < PostBoxSynth::numParamEnvs; ++i)
+            paramEnvs.add(new SimpleParams(1, 1));
+
+        for(auto voice : {bankVoice, ownVoice})
+        {
+            voice -> setSampleRate(sampleRate);
+            voice -> setNumChannels(2, nullptr);
+        }
+
+        AudioBuffer<float> bankOut(2, numBlocks * blockSize);
+        AudioBuffer<float> ownOut(2, numBlocks * blockSize);
+        bankOut.clear();
+        ownOut.clear();
+
+        //Two notes with different cut offs, each released so it ends early
+        const int noteOnBlocks[2] = {0, 100};
+        const int noteOffBlocks[2] = {40, 140};
+        const float cutoffs[2][2] = {{900.0f, 150.0f}, {3000.0f, 60.0f}};
+        int endedMidBlock = 0;
+        int playedBlocks = 0;
+        int bankBlocks = 0;
+
+        for(int b = 0; b < numBlocks; ++b)
+        {
+            const int blockStart = b * blockSize;
+
+            for(int n = 0; n < 2; ++n)
+            {
+                if(b == noteOnBlocks[n])
+                {
+                    for(int i = 0; i < PostBoxSynth::numFilters; ++i)
+                    {
+                        int choice[1] = {filterModes[i]};
+                        float params[2] = {cutoffs[n][i], 0.5f};
+                        filters[i] -> setParams(choice, params);
+                    }
+                    for(auto voice : {bankVoice, ownVoice})
+                    {
+                        voice -> setParams(envs, oscs, lfos, filters, drive, paramEnvs, 0);
+                        voice -> startNote(60 + 7 * n, 1.0f, nullptr, 0);
+                    }
+                }
+                else if(b == noteOffBlocks[n])
+                {
+                    bankVoice -> stopNote(1.0f, true);
+                    ownVoice -> stopNote(1.0f, true);
+                }
+            }
+
+            //The bank voice renders the way the synthesiser does with the bank shared bettween voices
+            const int played = bankVoice -> renderVoiceBlock(blockStart, blockSize, true);
+            if(played > 0)
+            {
+                if(played < blockSize)
+                    ++endedMidBlock;
+                bank.process(blockSize);
+                bankVoice -> finishVoiceBlock(bankOut, blockStart);
+                
+                //The lanes only hold a state if the voice handed its block to the bank
+                ++playedBlocks;
+                if(!bank.voiceSilent(0, 1.0e-9))
+                    ++bankBlocks;
+            }
+
+            ownVoice -> renderNextBlock(ownOut, blockStart, blockSize);
+        }
+
+        expectEquals(endedMidBlock, 2, "the notes did not end part way through a block");
+        expectEquals(bankBlocks, playedBlocks, "the voice used its own filters instead of the bank");
+
+        float maxDifference = 0.0f;
+        float maxLevel = 0.0f;
+        for(int c = 0; c < 2; ++c)
+        {
+            for(int i = 0; i < bankOut.getNumSamples(); ++i)
+            {
+                maxDifference = jmax(maxDifference, std::abs(bankOut.getSample(c, i) - ownOut.getSample(c, i)));
+                maxLevel = jmax(maxLevel, std::abs(ownOut.getSample(c, i)));
+            }
+        }
+
+        expect(maxLevel > 0.01f, "the voices were silent");
+        expectWithinAbsoluteError(maxDifference, 0.0f, 1.0e-5f * jmax(1.0f, maxLevel), "filter bank output drifted from the voices own filters");
+    }
+
+    /**
+     * Hands a voice in with a short ramping block to one bank, and to another bank as the short block
+     * then silence at the end cut offs, with a second voice playing full blocks in both, and checks they match
+     *
+     * @param lowPassMode is the mode of the low pass filter, 1 -12dB/oct and 2 -24dB/oct
+     * @param highPassMode is the mode of the high pass filter, 1 -12dB/oct and 2 -24dB/oct
+     *
+    */
+    void compareShortBlock(int lowPassMode, int highPassMode)
+    {
+        const int blockSize = VoiceFilterBank::maxBlockSize;
+        const int numBlocks = 40;
+        const int shortBlock = 10;
+        const int shortSamples = 20;
+        const int modes[2] = {lowPassMode, highPassMode};
+        const float startCutoffs[2] = {1000.0f, 200.0f};
+        const float endCutoffs[2] = {4000.0f, 80.0f};
+
+        VoiceFilterBank shortBank, splitBank;
+        shortBank.prepare(48000.0f, 2, 2);
+        splitBank.prepare(48000.0f, 2, 2);
+
+        Random noise(2);
+        float input[2][2][blockSize];
+        float shortOut[2][2][blockSize];
+        float splitOut[2][2][blockSize];
+        float silence[2][blockSize] = {};
+        float maxDifference = 0.0f;
+
+        for(int b = 0; b < numBlocks; ++b)
+        {
+            for(int v = 0; v < 2; ++v)
+            {
+                for(int c = 0; c < 2; ++c)
+                {
+                    for(int i = 0; i < blockSize; ++i)
+                        input[v][c][i] = noise.nextFloat() * 2.0f - 1.0f;
+                }
+            }
+
+            //The first voice moves its cut offs in the short block and keeps them after, the second never moves
+            const float* cutoffs[2] = {b < shortBlock ? startCutoffs : endCutoffs, startCutoffs};
+            const bool reset = b == 0;
+
+            if(b != shortBlock)
+            {
+                for(auto bank : {&shortBank, &splitBank})
+                {
+                    for(int v = 0; v < 2; ++v)
+                    {
+                        const float* channels[2] = {input[v][0], input[v][1]};
+                        bank -> submitVoice(v, channels, blockSize, modes, cutoffs[v], reset);
+                    }
+                    bank -> process(blockSize);
+                }
+                for(int v = 0; v < 2; ++v)
+                {
+                    float* shortChannels[2] = {shortOut[v][0], shortOut[v][1]};
+                    float* splitChannels[2] = {splitOut[v][0], splitOut[v][1]};
+                    shortBank.readVoice(v, shortChannels, blockSize);
+                    splitBank.readVoice(v, splitChannels, blockSize);
+                }
+            }
+            else
+            {
+                //The short bank filters the first voices short block in a full length block
+                for(int v = 0; v < 2; ++v)
+                {
+                    const float* channels[2] = {input[v][0], input[v][1]};
+                    shortBank.submitVoice(v, channels, v == 0 ? shortSamples : blockSize, modes, cutoffs[v], false);
+                }
+                shortBank.process(blockSize);
+
+                //The split bank filters the short block and then silence, with the second voice split to match
+                for(int v = 0; v < 2; ++v)
+                {
+                    const float* channels[2] = {input[v][0], input[v][1]};
+                    splitBank.submitVoice(v, channels, shortSamples, modes, cutoffs[v], false);
+                }
+                splitBank.process(shortSamples);
+
+                for(int v = 0; v < 2; ++v)
+                {
+                    const float* channels[2] = {v == 0 ? silence[0] : input[v][0] + shortSamples,
+                                                v == 0 ? silence[1] : input[v][1] + shortSamples};
+                    float* splitChannels[2] = {splitOut[v][0], splitOut[v][1]};
+                    splitBank.readVoice(v, splitChannels, shortSamples);
+                    splitBank.submitVoice(v, channels, blockSize - shortSamples, modes, cutoffs[v], false);
+                }
+                splitBank.process(blockSize - shortSamples);
+
+                for(int v = 0; v < 2; ++v)
+                {
+                    float* shortChannels[2] = {shortOut[v][0], shortOut[v][1]};
+                    float* splitChannels[2] = {splitOut[v][0] + shortSamples, splitOut[v][1] + shortSamples};
+                    shortBank.readVoice(v, shortChannels, blockSize);
+                    splitBank.readVoice(v, splitChannels, blockSize - shortSamples);
+                }
+            }
+
+            for(int v = 0; v < 2; ++v)
+            {
+                for(int c = 0; c < 2; ++c)
+                {
+                    for(int i = 0; i < blockSize; ++i)
+                        maxDifference = jmax(maxDifference, std::abs(shortOut[v][c][i] - splitOut[v][c][i]));
+                }
+            }
+        }
+
+        expectWithinAbsoluteError(maxDifference, 0.0f, 1.0e-5f, "a short block did not end in silence at its end cut offs");
+    }
+};
+
+static VoiceFilterBankTests voiceFilterBankTests;